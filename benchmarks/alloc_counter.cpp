@@ -0,0 +1,182 @@
+/* SPDX-License-Identifier: LGPL-2.1-or-later */
+
+#include "alloc_counter.hpp"
+
+#include <cerrno>
+#include <cstdlib>
+#include <new>
+
+// glibc entry points behind the interposed functions
+extern "C"
+{
+void* __libc_malloc(std::size_t);
+void* __libc_calloc(std::size_t, std::size_t);
+void* __libc_realloc(void*, std::size_t);
+void* __libc_memalign(std::size_t, std::size_t);
+void __libc_free(void*);
+}
+
+namespace
+{
+
+// initial-exec TLS doesn't allocate on the first access
+__attribute__((tls_model("initial-exec"))) thread_local std::uint64_t count = 0;
+
+void* counted(void* p)
+{
+    count++;
+    return p;
+}
+
+void* allocate(std::size_t size)
+{
+    if (auto p = __libc_malloc(size ? size : 1))
+    {
+        return counted(p);
+    }
+    throw std::bad_alloc();
+}
+
+void* allocate(std::size_t size, std::align_val_t align)
+{
+    if (auto p = __libc_memalign(static_cast<std::size_t>(align), size ? size : 1))
+    {
+        return counted(p);
+    }
+    throw std::bad_alloc();
+}
+
+} // namespace
+
+namespace bench
+{
+
+bool counting_allocations()
+{
+    return true;
+}
+
+std::uint64_t allocations()
+{
+    return count;
+}
+
+} // namespace bench
+
+extern "C"
+{
+
+void* malloc(std::size_t size)
+{
+    return counted(__libc_malloc(size));
+}
+
+void* calloc(std::size_t n, std::size_t size)
+{
+    return counted(__libc_calloc(n, size));
+}
+
+void* realloc(void* p, std::size_t size)
+{
+    return counted(__libc_realloc(p, size));
+}
+
+void* aligned_alloc(std::size_t align, std::size_t size)
+{
+    return counted(__libc_memalign(align, size));
+}
+
+int posix_memalign(void** p, std::size_t align, std::size_t size)
+{
+    *p = __libc_memalign(align, size);
+    if (!*p)
+    {
+        return ENOMEM;
+    }
+    counted(*p);
+    return 0;
+}
+
+void* memalign(std::size_t align, std::size_t size)
+{
+    return counted(__libc_memalign(align, size));
+}
+
+void free(void* p)
+{
+    __libc_free(p);
+}
+
+} // extern "C"
+
+// operator new is replaced as well, in case the C++ runtime doesn't
+// allocate through malloc
+void* operator new(std::size_t size)
+{
+    return allocate(size);
+}
+
+void* operator new[](std::size_t size)
+{
+    return allocate(size);
+}
+
+void* operator new(std::size_t size, const std::nothrow_t&) noexcept
+{
+    return counted(__libc_malloc(size ? size : 1));
+}
+
+void* operator new[](std::size_t size, const std::nothrow_t&) noexcept
+{
+    return counted(__libc_malloc(size ? size : 1));
+}
+
+void* operator new(std::size_t size, std::align_val_t align)
+{
+    return allocate(size, align);
+}
+
+void* operator new[](std::size_t size, std::align_val_t align)
+{
+    return allocate(size, align);
+}
+
+void operator delete(void* p) noexcept
+{
+    __libc_free(p);
+}
+
+void operator delete[](void* p) noexcept
+{
+    __libc_free(p);
+}
+
+void operator delete(void* p, std::size_t) noexcept
+{
+    __libc_free(p);
+}
+
+void operator delete[](void* p, std::size_t) noexcept
+{
+    __libc_free(p);
+}
+
+void operator delete(void* p, std::align_val_t) noexcept
+{
+    __libc_free(p);
+}
+
+void operator delete[](void* p, std::align_val_t) noexcept
+{
+    __libc_free(p);
+}
+
+void operator delete(void* p, std::size_t, std::align_val_t) noexcept
+{
+    __libc_free(p);
+}
+
+void operator delete[](void* p, std::size_t, std::align_val_t) noexcept
+{
+    __libc_free(p);
+}
@@ -0,0 +1,20 @@
+/* SPDX-License-Identifier: LGPL-2.1-or-later */
+
+#pragma once
+
+#include <cstdint>
+
+namespace bench
+{
+
+/**
+ * @brief Whether the allocation functions are interposed.
+ */
+bool counting_allocations();
+
+/**
+ * @brief Number of heap allocations made by the calling thread.
+ */
+std::uint64_t allocations();
+
+} // namespace bench
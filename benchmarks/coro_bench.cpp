@@ -0,0 +1,291 @@
+/* SPDX-License-Identifier: LGPL-2.1-or-later */
+
+#include "harness.hpp"
+
+#include <async/coro.hpp>
+#include <async/event.hpp>
+#include <async/function_ref.hpp>
+#include <async/impl/pending_op.hpp>
+#include <async/lock.hpp>
+#include <async/pending_group.hpp>
+#include <async/socket.hpp>
+#include <boost/asio/post.hpp>
+#include <netinet/in.h>
+#include <sys/socket.h>
+#include <unistd.h>
+
+#include <memory>
+#include <vector>
+
+namespace aio = async;
+
+/**
+ * @brief Connect two TCP sockets over the loopback.
+ */
+static bool connect_pair(aio::tcp::socket& client, aio::tcp::socket& server)
+{
+    sockaddr_in addr = {};
+    socklen_t len = sizeof(addr);
+
+    addr.sin_family = AF_INET;
+    addr.sin_addr.s_addr = htonl(INADDR_LOOPBACK);
+
+    int l = ::socket(AF_INET, SOCK_STREAM | SOCK_CLOEXEC, 0);
+    int c = ::socket(AF_INET, SOCK_STREAM | SOCK_CLOEXEC, 0);
+
+    bool ok = ::bind(l, reinterpret_cast<sockaddr*>(&addr), sizeof(addr)) == 0 &&
+              ::listen(l, 1) == 0 &&
+              ::getsockname(l, reinterpret_cast<sockaddr*>(&addr), &len) == 0 &&
+              ::connect(c, reinterpret_cast<sockaddr*>(&addr), sizeof(addr)) == 0;
+
+    int s = ok ? ::accept4(l, nullptr, nullptr, SOCK_CLOEXEC) : -1;
+
+    ::close(l);
+
+    if (s < 0)
+    {
+        ::close(c);
+        return false;
+    }
+
+    client = aio::tcp::socket(aio::tcp::proto::v4(), c);
+    server = aio::tcp::socket(aio::tcp::proto::v4(), s);
+    return true;
+}
+
+BENCHMARK(coro_start_finish)
+{
+    state.max_allocations = 0;
+
+    for (std::size_t i = 0; i < state.iterations; i++)
+    {
+        aio::coro<>::start("bench", [](aio::coro<>) {}).await();
+    }
+}
+
+BENCHMARK(yield_await)
+{
+    state.max_allocations = 0;
+
+    auto gen = aio::coro<std::size_t>::start(
+        "gen",
+        [](aio::coro<std::size_t> c, std::size_t n) {
+            for (std::size_t i = 0; i < n; i++)
+            {
+                c.yield(i);
+            }
+            return n;
+        },
+        std::size_t(state.iterations));
+
+    while (gen.running())
+    {
+        bench::keep(gen.await());
+    }
+}
+
+BENCHMARK(reschedule)
+{
+    state.max_allocations = 0;
+
+    auto c = aio::coro<>::start(
+        "resched",
+        [](aio::coro<> c, std::size_t n) {
+            for (std::size_t i = 0; i < n; i++)
+            {
+                c.reschedule();
+            }
+        },
+        std::size_t(state.iterations));
+
+    c.await();
+}
+
+BENCHMARK(event_broadcast_1000)
+{
+    constexpr std::size_t waiters = 1000;
+    const auto rounds = state.iterations;
+
+    auto wake = std::make_unique<aio::event[]>(rounds);
+    auto woken = std::make_unique<aio::event[]>(rounds);
+    aio::event ready;
+    std::size_t started = 0;
+    std::size_t count = 0;
+    std::vector<aio::coro<>> coros;
+
+    coros.reserve(waiters);
+    state.max_allocations = 0;
+
+    for (std::size_t i = 0; i < waiters; i++)
+    {
+        coros.push_back(aio::coro<>::start("waiter", [&](aio::coro<>) {
+            if (++started == waiters)
+            {
+                ready.set();
+            }
+
+            for (std::size_t r = 0; r < rounds; r++)
+            {
+                if (!wake[r].wait())
+                {
+                    return;
+                }
+
+                // the last one sets it after the others wait for the next round
+                if (++count % waiters == 0)
+                {
+                    woken[r].set();
+                }
+            }
+        }));
+    }
+
+    if (!ready.wait())
+    {
+        return;
+    }
+
+    state.items_per_iteration = waiters;
+    state.start_timing();
+
+    for (std::size_t r = 0; r < rounds; r++)
+    {
+        wake[r].set();
+        if (!woken[r].wait())
+        {
+            return;
+        }
+    }
+
+    state.stop_timing();
+
+    for (auto& c : coros)
+    {
+        c.await();
+    }
+}
+
+BENCHMARK(sema_contention_8)
+{
+    constexpr std::size_t workers = 8;
+    aio::sema sema;
+    std::vector<aio::coro<>> coros;
+
+    coros.reserve(workers);
+    state.max_allocations = 0;
+
+    for (std::size_t i = 0; i < workers; i++)
+    {
+        auto n = (state.iterations + workers - 1 - i) / workers;
+
+        coros.push_back(aio::coro<>::start("worker", [&sema, n](aio::coro<> c) {
+            for (std::size_t k = 0; k < n; k++)
+            {
+                if (!sema.lock())
+                {
+                    return;
+                }
+                // let the others queue on the semaphore
+                c.reschedule();
+                sema.unlock();
+            }
+        }));
+    }
+
+    for (auto& c : coros)
+    {
+        c.await();
+    }
+}
+
+BENCHMARK(socket_roundtrip)
+{
+    constexpr std::size_t size = 64;
+    aio::tcp::socket client;
+    aio::tcp::socket server;
+
+    if (!connect_pair(client, server))
+    {
+        return;
+    }
+
+    auto echo = aio::coro<>::start(
+        "echo",
+        [](aio::coro<>, aio::tcp::socket* s) {
+            char buffer[size];
+            std::size_t n;
+
+            // receive, process, send back
+            while (!s->async_read_exact({buffer, size}, n))
+            {
+                for (auto& c : buffer)
+                {
+                    c ^= 0x5a;
+                }
+
+                if (s->async_write_all({buffer, size}, n))
+                {
+                    break;
+                }
+            }
+        },
+        &server);
+
+    char buffer[size] = {};
+    std::size_t n;
+
+    state.max_allocations = 0;
+
+    for (std::size_t i = 0; i < state.iterations; i++)
+    {
+        client.async_write_all({buffer, size}, n);
+        client.async_read_exact({buffer, size}, n);
+    }
+
+    client.close();
+    echo.await();
+    server.close();
+}
+
+BENCHMARK(pending_group_wait_all_4)
+{
+    constexpr std::size_t ops = 4;
+    auto executor = aio::impl::io::get_executor();
+    auto complete = [] { return true; };
+
+    state.items_per_iteration = ops;
+
+    for (std::size_t i = 0; i < state.iterations; i++)
+    {
+        aio::pending_group pg;
+
+        for (std::size_t k = 0; k < ops; k++)
+        {
+            aio::function_ref<bool()> f(&complete);
+            pg += boost::asio::post(executor, aio::defer_t<bool()>(f));
+        }
+
+        bench::keep(pg.wait_all());
+    }
+}
+
+BENCHMARK(function_ref_invoke)
+{
+    std::size_t sum = 0;
+    auto add = [&sum](std::size_t v) { sum += v; };
+    aio::function_ref<void(std::size_t)> f(&add);
+
+    for (std::size_t i = 0; i < state.iterations; i++)
+    {
+        // reload the reference, as if passed from elsewhere
+        bench::keep(f);
+        f(i);
+    }
+
+    bench::keep(sum);
+}
+
+int main(int argc, char** argv)
+{
+    return bench::run(argc, argv);
+}
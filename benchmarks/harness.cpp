@@ -0,0 +1,256 @@
+/* SPDX-License-Identifier: LGPL-2.1-or-later */
+
+#include "harness.hpp"
+
+#include "alloc_counter.hpp"
+
+#include <async/coro.hpp>
+#include <async/scheduler.hpp>
+
+#include <algorithm>
+#include <cstdio>
+#include <cstring>
+#include <ctime>
+#include <string_view>
+#include <vector>
+
+namespace bench
+{
+
+#ifndef BENCH_ALLOC_COUNTING
+bool counting_allocations()
+{
+    return false;
+}
+
+std::uint64_t allocations()
+{
+    return 0;
+}
+#endif
+
+namespace
+{
+
+struct benchmark
+{
+    std::string name;
+    function func;
+};
+
+struct result
+{
+    std::string name;
+    std::size_t iterations;
+    double real_time;
+    double items_per_second;
+    double allocations = -1;
+    bool failed = false;
+};
+
+struct options
+{
+    std::string filter;
+    std::string json;
+    double min_time = 0.5;
+};
+
+std::vector<benchmark>& registry()
+{
+    static std::vector<benchmark> list;
+    return list;
+}
+
+double run_once(const benchmark& b, state& s)
+{
+    auto started = clock::now();
+    b.func(s);
+    auto stopped = clock::now();
+
+    if (s.started != clock::time_point{})
+    {
+        started = s.started;
+    }
+    if (s.stopped != clock::time_point{})
+    {
+        stopped = s.stopped;
+    }
+
+    return std::chrono::duration<double>(stopped - started).count();
+}
+
+result run_benchmark(const benchmark& b, const options& opts)
+{
+    std::size_t n = 1;
+
+    // untimed pass, the first run fills the caches and freelists
+    state warmup(n);
+    b.func(warmup);
+
+    while (true)
+    {
+        state s(n);
+        auto elapsed = run_once(b, s);
+
+        if (elapsed >= opts.min_time || n >= 1000000000)
+        {
+            auto items = double(n) * s.items_per_iteration;
+            return {b.name, n, elapsed * 1e9 / n, items / elapsed};
+        }
+
+        // aim slightly above the minimal time, growing at most 10 times
+        auto scale = elapsed > 0 ? opts.min_time * 1.4 / elapsed : 10.0;
+        n = std::max(n + 1, std::size_t(n * std::clamp(scale, 2.0, 10.0)));
+    }
+}
+
+/**
+ * @brief Measure heap allocations per operation in the steady state.
+ *
+ * Setup allocations are the same in both runs and cancel out.
+ */
+void check_allocations(const benchmark& b, std::size_t n, result& r)
+{
+    state once(n);
+    auto before = allocations();
+    b.func(once);
+    auto single = allocations() - before;
+
+    state twice(2 * n);
+    before = allocations();
+    b.func(twice);
+    auto dual = allocations() - before;
+
+    r.allocations = std::max(0.0, (double(dual) - double(single)) / n);
+    r.failed = twice.max_allocations >= 0 && r.allocations > twice.max_allocations + 0.01;
+}
+
+void write_json(const std::string& path, const std::vector<result>& results)
+{
+    auto f = std::fopen(path.c_str(), "w");
+    if (!f)
+    {
+        std::perror(path.c_str());
+        return;
+    }
+
+    char date[64];
+    auto now = std::time(nullptr);
+    std::strftime(date, sizeof(date), "%FT%T%z", std::localtime(&now));
+
+    std::fprintf(f, "{\n  \"context\": {\n");
+    std::fprintf(f, "    \"date\": \"%s\",\n    \"library\": \"async\"\n  },\n", date);
+    std::fprintf(f, "  \"benchmarks\": [\n");
+
+    for (std::size_t i = 0; i < results.size(); i++)
+    {
+        const auto& r = results[i];
+
+        std::fprintf(f,
+                     "    {\"name\": \"%s\", \"iterations\": %zu, \"real_time\": %.3f, "
+                     "\"time_unit\": \"ns\", \"items_per_second\": %.1f",
+                     r.name.c_str(), r.iterations, r.real_time, r.items_per_second);
+
+        if (r.allocations >= 0)
+        {
+            std::fprintf(f, ", \"allocations_per_iteration\": %.3f", r.allocations);
+        }
+
+        std::fprintf(f, "}%s\n", i + 1 < results.size() ? "," : "");
+    }
+
+    std::fprintf(f, "  ]\n}\n");
+    std::fclose(f);
+}
+
+bool parse(int argc, char** argv, options& opts)
+{
+    for (int i = 1; i < argc; i++)
+    {
+        std::string_view arg(argv[i]);
+
+        if (arg.starts_with("--filter="))
+        {
+            opts.filter = arg.substr(9);
+        }
+        else if (arg.starts_with("--min-time="))
+        {
+            opts.min_time = std::atof(argv[i] + 11);
+        }
+        else if (arg.starts_with("--json="))
+        {
+            opts.json = arg.substr(7);
+        }
+        else
+        {
+            std::fprintf(stderr, "unknown option %s\n", argv[i]);
+            return false;
+        }
+    }
+
+    return true;
+}
+
+} // namespace
+
+registrar::registrar(std::string name, function func)
+{
+    registry().push_back({std::move(name), std::move(func)});
+}
+
+int run(int argc, char** argv)
+{
+    options opts;
+    std::vector<result> results;
+    bool failed = false;
+
+    if (!parse(argc, argv, opts))
+    {
+        return 1;
+    }
+
+    async::coro<>::start("bench", [&](async::coro<>) {
+        std::printf("%-32s %14s %14s %16s", "benchmark", "iterations", "ns/op", "items/s");
+        if (counting_allocations())
+        {
+            std::printf(" %10s", "allocs/op");
+        }
+        std::printf("\n");
+
+        for (const auto& b : registry())
+        {
+            if (b.name.find(opts.filter) == std::string::npos)
+            {
+                continue;
+            }
+
+            auto r = run_benchmark(b, opts);
+
+            std::printf("%-32s %14zu %14.1f %16.0f", r.name.c_str(), r.iterations, r.real_time,
+                        r.items_per_second);
+
+            if (counting_allocations())
+            {
+                check_allocations(b, std::clamp<std::size_t>(r.iterations, 1, 1000), r);
+                std::printf(" %10.3f%s", r.allocations, r.failed ? "  FAILED" : "");
+                failed = failed || r.failed;
+            }
+
+            std::printf("\n");
+            results.push_back(std::move(r));
+        }
+
+        async::scheduler::stop();
+    });
+
+    async::scheduler::run();
+
+    if (!opts.json.empty())
+    {
+        write_json(opts.json, results);
+    }
+
+    return failed ? 1 : 0;
+}
+
+} // namespace bench
@@ -0,0 +1,84 @@
+/* SPDX-License-Identifier: LGPL-2.1-or-later */
+
+#pragma once
+
+#include <chrono>
+#include <cstddef>
+#include <functional>
+#include <string>
+
+namespace bench
+{
+
+using clock = std::chrono::steady_clock;
+
+/**
+ * @brief State of a single benchmark run.
+ *
+ * The function runs the operation iterations times. Setup and teardown
+ * may be excluded with start_timing()/stop_timing(), otherwise the whole
+ * call is measured.
+ */
+struct state
+{
+    explicit state(std::size_t n) : iterations(n)
+    {}
+
+    void start_timing()
+    {
+        started = clock::now();
+    }
+
+    void stop_timing()
+    {
+        stopped = clock::now();
+    }
+
+    // operations to run
+    std::size_t iterations;
+    // items processed by one operation, e.g. woken waiters
+    std::size_t items_per_iteration = 1;
+    // steady state heap allocations allowed per operation, checked when
+    // built with alloc_counting, negative to skip the check
+    double max_allocations = -1;
+
+    clock::time_point started{};
+    clock::time_point stopped{};
+};
+
+using function = std::function<void(state&)>;
+
+/**
+ * @brief Register benchmark to be run by run().
+ */
+struct registrar
+{
+    registrar(std::string name, function func);
+};
+
+/**
+ * @brief Prevent the compiler from optimizing the value away.
+ */
+template <typename T>
+inline void keep(T&& value)
+{
+    asm volatile("" : : "r,m"(value) : "memory");
+}
+
+/**
+ * @brief Run registered benchmarks in a coroutine.
+ *
+ * Options: --filter=<substring>, --min-time=<seconds>, --json=<file>.
+ * Every benchmark is run once untimed before the measured runs. Results
+ * are printed as a table, and written as JSON if requested. Returns
+ * non-zero on an unknown option, or if a benchmark exceeds its allocation
+ * limit.
+ */
+int run(int argc, char** argv);
+
+} // namespace bench
+
+#define BENCHMARK(name)                                                                            \
+    static void name(bench::state&);                                                               \
+    static bench::registrar name##_registrar(#name, name);                                         \
+    static void name(bench::state& state)
@@ -0,0 +1,440 @@
+/* SPDX-License-Identifier: LGPL-2.1-or-later */
+
+#include "harness.hpp"
+
+#include <async/coro.hpp>
+#include <async/event.hpp>
+#include <async/impl/this_coro.hpp>
+#include <async/lock.hpp>
+#include <async/scheduler.hpp>
+#include <async/socket.hpp>
+#include <boost/asio/steady_timer.hpp>
+#include <sys/resource.h>
+
+#include <array>
+#include <bit>
+#include <cstdio>
+#include <cstring>
+#include <deque>
+#include <string_view>
+#include <vector>
+
+namespace aio = async;
+
+namespace
+{
+
+struct options
+{
+    std::size_t connections = 64;
+    std::size_t size = 64;
+    std::size_t depth = 1;
+    double duration = 5;
+    unsigned short port = 19000;
+    std::string json;
+};
+
+/**
+ * @brief Log-linear latency histogram with about 3% precision.
+ */
+struct histogram
+{
+    static constexpr unsigned sub_bits = 5;
+    static constexpr std::uint64_t sub_count = 1 << sub_bits;
+
+    void add(std::uint64_t v)
+    {
+        counts[index(v)]++;
+        total++;
+    }
+
+    std::uint64_t percentile(double p) const
+    {
+        auto rank = std::uint64_t(p * total);
+        std::uint64_t seen = 0;
+
+        for (std::size_t i = 0; i < counts.size(); i++)
+        {
+            seen += counts[i];
+            if (seen > rank)
+            {
+                return value(i);
+            }
+        }
+
+        return 0;
+    }
+
+    static std::size_t index(std::uint64_t v)
+    {
+        if (v < sub_count)
+        {
+            return v;
+        }
+
+        unsigned shift = std::bit_width(v) - 1 - sub_bits;
+        return ((shift + 1) << sub_bits) | ((v >> shift) & (sub_count - 1));
+    }
+
+    static std::uint64_t value(std::size_t i)
+    {
+        if (i < sub_count)
+        {
+            return i;
+        }
+
+        unsigned shift = (i >> sub_bits) - 1;
+        return ((sub_count | (i & (sub_count - 1))) << shift) + (std::uint64_t(1) << shift) / 2;
+    }
+
+    std::array<std::uint64_t, (64 - sub_bits + 1) << sub_bits> counts{};
+    std::uint64_t total = 0;
+};
+
+struct context
+{
+    options opts;
+    aio::tcp::address_v4 address = aio::tcp::address_v4::loopback();
+    std::vector<aio::tcp::acceptor> acceptors;
+    histogram latency;
+    std::size_t requests = 0;
+    bool measuring = false;
+    bool stopping = false;
+    bool failed = false;
+};
+
+// connections from one client address to one port are limited by
+// the ephemeral port range
+constexpr std::size_t connections_per_port = 20000;
+
+std::size_t rss()
+{
+    long pages = 0;
+
+    if (auto f = std::fopen("/proc/self/statm", "r"))
+    {
+        std::fscanf(f, "%*s %ld", &pages);
+        std::fclose(f);
+    }
+
+    return pages * sysconf(_SC_PAGESIZE);
+}
+
+void sleep(double seconds)
+{
+    boost::asio::steady_timer timer(aio::impl::io::get_executor());
+    timer.expires_after(std::chrono::duration_cast<bench::clock::duration>(
+        std::chrono::duration<double>(seconds)));
+    timer.async_wait(aio::this_coro);
+}
+
+void echo(aio::coro<>, aio::tcp::socket s, std::size_t size)
+{
+    std::vector<char> buffer(size);
+    std::size_t n;
+
+    while (!s.async_read_exact({buffer.data(), size}, n) &&
+           !s.async_write_all({buffer.data(), size}, n))
+    {}
+
+    s.close();
+}
+
+void accept(aio::coro<>, aio::tcp::acceptor* acceptor, std::size_t size)
+{
+    while (true)
+    {
+        aio::tcp::socket s;
+
+        if (acceptor->async_accept(s))
+        {
+            break;
+        }
+
+        s.boost_socket().set_option(boost::asio::ip::tcp::no_delay(true));
+        aio::coro<>::start("echo", echo, std::move(s), std::size_t(size));
+    }
+}
+
+using send_times = std::deque<bench::clock::time_point>;
+
+void read_echo(aio::coro<>, context* c, aio::tcp::socket* socket, send_times* sent,
+               aio::sema* room)
+{
+    auto& ctx = *c;
+    auto size = ctx.opts.size;
+    std::vector<char> in(size);
+    std::size_t n;
+
+    while (!socket->async_read_exact({in.data(), size}, n))
+    {
+        if (ctx.measuring)
+        {
+            auto elapsed = bench::clock::now() - sent->front();
+            ctx.latency.add(std::chrono::nanoseconds(elapsed).count());
+            ctx.requests++;
+        }
+
+        sent->pop_front();
+        room->unlock();
+    }
+
+    // the writer may wait for the room
+    room->unlock();
+}
+
+void client(aio::coro<>, context* c, aio::tcp::socket* socket)
+{
+    auto& ctx = *c;
+    auto& s = *socket;
+    auto size = ctx.opts.size;
+    std::vector<char> out(size, 'x');
+    send_times sent;
+    aio::sema room;
+    std::size_t n;
+
+    // the echo is read concurrently, the pipelined requests need not fit
+    // the socket buffers
+    auto reader = aio::coro<>::start("reader", read_echo, &ctx, &s, &sent, &room);
+    reader.set_cancel_errors();
+
+    while (!ctx.stopping && reader.running())
+    {
+        if (sent.size() >= ctx.opts.depth)
+        {
+            if (!room.lock())
+            {
+                break;
+            }
+            continue;
+        }
+
+        sent.push_back(bench::clock::now());
+
+        if (s.async_write_all({out.data(), size}, n))
+        {
+            break;
+        }
+    }
+
+    // drain the requests in flight
+    while (!sent.empty() && reader.running())
+    {
+        if (!room.lock())
+        {
+            break;
+        }
+    }
+
+    reader.cancel();
+    reader.try_await();
+}
+
+bool raise_fd_limit(std::size_t needed)
+{
+    rlimit rl;
+
+    if (getrlimit(RLIMIT_NOFILE, &rl) != 0)
+    {
+        return false;
+    }
+
+    rl.rlim_cur = rl.rlim_max;
+    setrlimit(RLIMIT_NOFILE, &rl);
+
+    return rl.rlim_cur >= needed;
+}
+
+void write_json(const context& ctx, double rate, std::size_t rss_per_connection)
+{
+    auto f = std::fopen(ctx.opts.json.c_str(), "w");
+    if (!f)
+    {
+        std::perror(ctx.opts.json.c_str());
+        return;
+    }
+
+    std::fprintf(f, "{\n  \"context\": {\"library\": \"async\", \"benchmark\": \"tcp_echo\"},\n");
+    std::fprintf(f, "  \"connections\": %zu,\n  \"size\": %zu,\n  \"depth\": %zu,\n",
+                 ctx.opts.connections, ctx.opts.size, ctx.opts.depth);
+    std::fprintf(f, "  \"requests\": %zu,\n  \"requests_per_second\": %.1f,\n", ctx.requests, rate);
+    std::fprintf(f, "  \"latency_ns\": {\"p50\": %lu, \"p99\": %lu, \"p999\": %lu},\n",
+                 ctx.latency.percentile(0.5), ctx.latency.percentile(0.99),
+                 ctx.latency.percentile(0.999));
+    std::fprintf(f, "  \"rss_per_connection\": %zu\n}\n", rss_per_connection);
+    std::fclose(f);
+}
+
+void run(aio::coro<>, context* c)
+{
+    auto& ctx = *c;
+    const auto& opts = ctx.opts;
+    auto ports = (opts.connections + connections_per_port - 1) / connections_per_port;
+
+    ctx.acceptors = std::vector<aio::tcp::acceptor>(ports);
+
+    for (std::size_t i = 0; i < ports; i++)
+    {
+        aio::tcp::endpoint ep(ctx.address, opts.port + i);
+
+        if (auto ec = ctx.acceptors[i].listen_shared(ep))
+        {
+            std::fprintf(stderr, "listen on port %zu: %s\n", opts.port + i, ec.message().c_str());
+            ctx.failed = true;
+            aio::scheduler::stop(true);
+            return;
+        }
+    }
+
+    std::vector<aio::coro<>> acceptors;
+
+    for (auto& a : ctx.acceptors)
+    {
+        acceptors.push_back(aio::coro<>::start("accept", accept, &a, std::size_t(opts.size)));
+    }
+
+    auto rss_base = rss();
+
+    // connect one by one not to overflow the listen backlog
+    std::vector<aio::tcp::socket> sockets(opts.connections);
+
+    for (std::size_t i = 0; i < sockets.size(); i++)
+    {
+        aio::tcp::endpoint ep(ctx.address, opts.port + i / connections_per_port);
+
+        if (auto ec = sockets[i].async_connect(ep))
+        {
+            std::fprintf(stderr, "connect %zu: %s\n", i, ec.message().c_str());
+            ctx.failed = true;
+            aio::scheduler::stop(true);
+            return;
+        }
+
+        sockets[i].boost_socket().set_option(boost::asio::ip::tcp::no_delay(true));
+    }
+
+    std::vector<aio::coro<>> clients;
+
+    for (auto& s : sockets)
+    {
+        clients.push_back(aio::coro<>::start("client", client, &ctx, &s));
+    }
+
+    // warm up, then measure
+    sleep(std::min(1.0, opts.duration / 5));
+
+    ctx.measuring = true;
+    auto started = bench::clock::now();
+
+    sleep(opts.duration);
+
+    ctx.measuring = false;
+    auto elapsed = std::chrono::duration<double>(bench::clock::now() - started).count();
+    auto rss_per_connection = (rss() - rss_base) / opts.connections;
+
+    ctx.stopping = true;
+
+    for (auto& c : clients)
+    {
+        c.await();
+    }
+
+    for (auto& s : sockets)
+    {
+        s.close();
+    }
+
+    for (auto& a : ctx.acceptors)
+    {
+        a.close();
+    }
+
+    auto rate = ctx.requests / elapsed;
+
+    std::printf("connections %zu, size %zu, depth %zu\n", opts.connections, opts.size,
+                opts.depth);
+    std::printf("requests/s  %.0f\n", rate);
+    std::printf("latency us  p50 %.1f  p99 %.1f  p999 %.1f\n", ctx.latency.percentile(0.5) / 1e3,
+                ctx.latency.percentile(0.99) / 1e3, ctx.latency.percentile(0.999) / 1e3);
+    std::printf("rss/conn    %zu bytes (both ends)\n", rss_per_connection);
+
+    if (!opts.json.empty())
+    {
+        write_json(ctx, rate, rss_per_connection);
+    }
+
+    aio::scheduler::stop();
+}
+
+bool parse(int argc, char** argv, options& opts)
+{
+    for (int i = 1; i < argc; i++)
+    {
+        std::string_view arg(argv[i]);
+        auto value = arg.substr(arg.find('=') + 1);
+
+        if (arg.starts_with("--connections="))
+        {
+            opts.connections = std::max(1ul, std::strtoul(value.data(), nullptr, 10));
+        }
+        else if (arg.starts_with("--size="))
+        {
+            opts.size = std::max(1ul, std::strtoul(value.data(), nullptr, 10));
+        }
+        else if (arg.starts_with("--depth="))
+        {
+            opts.depth = std::max(1ul, std::strtoul(value.data(), nullptr, 10));
+        }
+        else if (arg.starts_with("--duration="))
+        {
+            opts.duration = std::atof(value.data());
+        }
+        else if (arg.starts_with("--port="))
+        {
+            opts.port = std::strtoul(value.data(), nullptr, 10);
+        }
+        else if (arg.starts_with("--json="))
+        {
+            opts.json = value;
+        }
+        else
+        {
+            std::fprintf(stderr, "unknown option %s\n", argv[i]);
+            return false;
+        }
+    }
+
+    return true;
+}
+
+} // namespace
+
+/**
+ * TCP echo over the loopback: every client connection keeps depth
+ * requests of the given size in flight while reading their echo.
+ *
+ * Options: --connections=<n>, --size=<bytes>, --depth=<n>,
+ * --duration=<seconds>, --port=<first port>, --json=<file>.
+ */
+int main(int argc, char** argv)
+{
+    context ctx;
+
+    if (!parse(argc, argv, ctx.opts))
+    {
+        return 1;
+    }
+
+    // both ends of every connection, and some spare
+    if (!raise_fd_limit(ctx.opts.connections * 2 + 64))
+    {
+        std::fprintf(stderr, "open files limit is too low for %zu connections\n",
+                     ctx.opts.connections);
+        return 1;
+    }
+
+    aio::coro<>::start("run", run, &ctx);
+    aio::scheduler::run();
+
+    return ctx.failed ? 1 : 0;
+}
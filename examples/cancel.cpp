@@ -0,0 +1,165 @@
+/* SPDX-License-Identifier: LGPL-2.1-or-later */
+
+#include <async/coro.hpp>
+#include <async/event.hpp>
+#include <async/lock.hpp>
+#include <async/scheduler.hpp>
+#include <async/udp.hpp>
+
+#include <stdexcept>
+
+namespace aio = async;
+
+static bool s_failed = false;
+
+static void check(bool ok, const char* what)
+{
+    printf("%s: %s\n", what, ok ? "ok" : "FAILED");
+    s_failed |= !ok;
+}
+
+// let the started coroutines run up to their suspension points
+static void settle(aio::coro<>& c)
+{
+    for (int i = 0; i < 10; i++)
+    {
+        c.reschedule();
+    }
+}
+
+static void check_try_await(aio::coro<>& c)
+{
+    aio::event never;
+
+    // canceled in error mode, the wait fails and the value is returned
+    auto errors = aio::coro<int>::start("errors", [&](auto e) {
+        e.set_cancel_errors();
+        return never.wait() ? 1 : 42;
+    });
+
+    // canceled in throw mode, the stack is unwound
+    auto throws = aio::coro<int>::start("throws", [&](auto) { return never.wait() ? 1 : 2; });
+
+    auto failing = aio::coro<int>::start("failing", [](auto) -> int {
+        throw std::runtime_error("failed");
+    });
+
+    throws.set_cancel_throws();
+    settle(c);
+    errors.cancel();
+    throws.cancel();
+
+    auto r = errors.try_await();
+    check(r && *r == 42, "error mode returns the value");
+
+    r = throws.try_await();
+    check(!r && r.error().code == boost::asio::error::operation_aborted && !r.error().exception,
+          "throw mode returns operation_aborted");
+
+    r = failing.try_await();
+    check(!r && r.error().exception, "exception is returned");
+
+    // the waiter is canceled, not the target
+    aio::event go;
+    auto target = aio::coro<int>::start("target", [&](auto) { return go.wait() ? 7 : 0; });
+    auto waiter = aio::coro<bool>::start("waiter", [&](auto w) {
+        w.set_cancel_errors();
+        auto r = target.try_await();
+        return !r && r.error().code == boost::asio::error::operation_aborted;
+    });
+
+    settle(c);
+    waiter.cancel();
+    check(waiter.await(), "canceled waiter returns operation_aborted");
+
+    go.set();
+    r = target.try_await();
+    check(r && *r == 7, "target keeps running");
+}
+
+static void check_sema(aio::coro<>& c)
+{
+    aio::sema sema;
+
+    if (!sema.lock())
+    {
+        return;
+    }
+
+    // canceled after the hand-off, the waiter owns the semaphore
+    auto owner = aio::coro<bool>::start("owner", [&](auto o) {
+        o.set_cancel_errors();
+        return sema.lock();
+    });
+
+    settle(c);
+    sema.unlock();
+    owner.cancel();
+
+    check(owner.await(), "handed off semaphore is kept");
+
+    // canceled before the hand-off, the next waiter gets the semaphore
+    auto canceled = aio::coro<bool>::start("canceled", [&](auto w) {
+        w.set_cancel_errors();
+        return sema.lock();
+    });
+    auto next = aio::coro<bool>::start("next", [&](auto) { return sema.lock(); });
+
+    settle(c);
+    canceled.cancel();
+    sema.unlock();
+
+    check(!canceled.await(), "canceled waiter fails");
+    check(next.await(), "next waiter locks");
+}
+
+// canceled in the default mode, the coroutine still gets its completion
+static void check_default_mode(aio::coro<>& c)
+{
+    aio::udp::socket a(aio::udp::endpoint(aio::udp::address_v4::loopback(), 0));
+    aio::udp::socket b(aio::udp::endpoint(aio::udp::address_v4::loopback(), 0));
+    char data[16];
+
+    auto receiver = aio::coro<std::size_t>::start("receiver", [&](auto) {
+        std::size_t n = 0;
+        a.async_receive(aio::udp::socket::mutable_buffer(data, sizeof(data)), n);
+        return n;
+    });
+
+    settle(c);
+    receiver.cancel();
+
+    std::size_t n;
+    b.async_send_to(aio::udp::socket::const_buffer("ping", 4), a.boost_socket().local_endpoint(),
+                    n);
+    settle(c);
+
+    bool completed = !receiver.running();
+
+    if (!completed)
+    {
+        receiver.set_cancel_errors();
+        receiver.cancel();
+    }
+    check(completed && receiver.await() == 4, "completion after default cancel");
+}
+
+static void main_coro(aio::coro<> c)
+{
+    check_try_await(c);
+    check_sema(c);
+    check_default_mode(c);
+
+    aio::scheduler::stop();
+}
+
+int main()
+{
+    aio::scheduler::setup_signal_handlers();
+
+    aio::coro<>::start("main", main_coro);
+
+    aio::scheduler::run();
+
+    return s_failed ? 1 : 0;
+}
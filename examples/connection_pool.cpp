@@ -0,0 +1,165 @@
+/* SPDX-License-Identifier: LGPL-2.1-or-later */
+
+#include <async/connection_pool.hpp>
+#include <async/coro.hpp>
+#include <async/scheduler.hpp>
+
+namespace aio = async;
+
+static bool s_failed = false;
+
+static void check(bool ok, const char* what)
+{
+    printf("%s: %s\n", what, ok ? "ok" : "FAILED");
+    s_failed |= !ok;
+}
+
+// let a coroutine finish an operation that completes at once
+static bool settle(aio::coro<>& c, const auto& task)
+{
+    for (int i = 0; i < 100 && task.running(); i++)
+    {
+        c.reschedule();
+    }
+
+    return !task.running();
+}
+
+// workers share two connections, every connection is reused
+static void check_reuse(aio::coro<>& c)
+{
+    aio::tcp::endpoint ep(aio::tcp::address_v4::loopback(), 34583);
+    aio::tcp::acceptor acceptor(ep, true);
+    std::vector<aio::tcp::socket> accepted;
+
+    acceptor.listen();
+
+    auto server = aio::coro<>::start("server", [&](auto) {
+        aio::tcp::socket s;
+
+        while (!acceptor.async_accept(s))
+        {
+            accepted.push_back(std::move(s));
+        }
+    });
+
+    aio::tcp::connection_pool pool({.max_active = 2});
+    std::vector<aio::coro<bool>> workers;
+    std::size_t active = 0;
+    std::size_t max_active = 0;
+
+    for (int i = 0; i < 6; i++)
+    {
+        workers.push_back(aio::coro<bool>::start("worker", [&](auto w) {
+            for (int n = 0; n < 10; n++)
+            {
+                aio::tcp::socket s;
+
+                if (pool.acquire(ep, s))
+                {
+                    return false;
+                }
+
+                max_active = std::max(max_active, ++active);
+                w.reschedule();
+                active--;
+                pool.release(ep, std::move(s));
+            }
+            return true;
+        }));
+    }
+
+    // waiter canceled while both connections are handed out
+    aio::tcp::socket held[2];
+    check(!pool.acquire(ep, held[0]) && !pool.acquire(ep, held[1]), "acquire");
+
+    auto waiter = aio::coro<aio::error_code>::start_lazy("waiter", [&](auto w) {
+        aio::tcp::socket s;
+        w.set_cancel_errors();
+        return pool.acquire(ep, s);
+    });
+
+    waiter.run();
+    c.reschedule();
+    waiter.cancel();
+
+    auto r = waiter.try_await();
+    check(r && *r == boost::asio::error::operation_aborted, "canceled waiter");
+
+    pool.release(ep, std::move(held[0]));
+    pool.release(ep, std::move(held[1]));
+
+    bool done = true;
+    for (auto& w : workers)
+    {
+        done &= w.await();
+    }
+
+    check(done && max_active <= 2, "workers share the connections");
+    check(accepted.size() == 2, "connections reused");
+
+    acceptor.close();
+    server.await();
+}
+
+// connect unwound while the listener does not accept
+static void check_unwound_connect(aio::coro<>& c)
+{
+    aio::tcp::endpoint ep(aio::tcp::address_v4::loopback(), 34584);
+    aio::tcp::acceptor acceptor(ep, true);
+    aio::tcp::socket queued;
+
+    // the accept queue of one connection is full, later connects wait
+    acceptor.listen(0);
+    check(!queued.async_connect(ep), "fill the accept queue");
+
+    aio::tcp::connection_pool pool({.max_active = 1});
+
+    auto unwound = aio::coro<>::start_lazy("unwound", [&](auto) {
+        aio::tcp::socket s;
+        (void)pool.acquire(ep, s);
+    });
+
+    unwound.set_cancel_throws();
+    unwound.run();
+    c.reschedule();
+    unwound.cancel();
+    check(!unwound.try_await(), "unwound connect");
+
+    // the slot is free again, the next connect is refused at once
+    acceptor.close();
+
+    auto next = aio::coro<aio::error_code>::start_lazy("next", [&](auto n) {
+        aio::tcp::socket s;
+        n.set_cancel_errors();
+        return pool.acquire(ep, s);
+    });
+
+    next.run();
+    if (!settle(c, next))
+    {
+        next.cancel();
+    }
+
+    auto ec = next.try_await();
+    check(ec && *ec == boost::asio::error::connection_refused, "slot released by unwinding");
+}
+
+static void main_coro(aio::coro<> c)
+{
+    check_reuse(c);
+    check_unwound_connect(c);
+
+    aio::scheduler::stop();
+}
+
+int main()
+{
+    aio::scheduler::setup_signal_handlers();
+
+    aio::coro<>::start("main", main_coro);
+
+    aio::scheduler::run();
+
+    return s_failed ? 1 : 0;
+}
@@ -0,0 +1,158 @@
+/* SPDX-License-Identifier: LGPL-2.1-or-later */
+
+#include <async/coro.hpp>
+#include <async/coro_local.hpp>
+#include <async/event.hpp>
+#include <async/scheduler.hpp>
+
+#include <string>
+
+namespace aio = async;
+
+static bool s_failed = false;
+
+static void check(bool ok, const char* what)
+{
+    printf("%s: %s\n", what, ok ? "ok" : "FAILED");
+    s_failed |= !ok;
+}
+
+static int s_alive = 0;
+
+// heap allocated value counting the live instances
+struct request_id
+{
+    request_id(std::string id) : id(std::move(id))
+    {
+        s_alive++;
+    }
+
+    ~request_id()
+    {
+        s_alive--;
+    }
+
+    std::string id;
+};
+
+struct retries_tag;
+struct timeouts_tag;
+
+using request = aio::coro_local<request_id>;
+using retries = aio::coro_local<int, retries_tag>;
+using timeouts = aio::coro_local<int, timeouts_tag>;
+
+// sets a slot allocated after all the others from its destructor
+struct late_slot
+{
+    ~late_slot();
+};
+
+struct late_tag;
+using late = aio::coro_local<late_slot>;
+using last = aio::coro_local<std::string, late_tag>;
+
+late_slot::~late_slot()
+{
+    // the slots grow, the value being destroyed must not be touched
+    last::emplace(std::string(1000, 'x'));
+}
+
+// coroutines interleave, every one sees its own values
+static void check_concurrent(aio::coro<>& c)
+{
+    std::vector<aio::coro<bool>> workers;
+
+    for (int i = 0; i < 8; i++)
+    {
+        workers.push_back(aio::coro<bool>::start("worker", [i](auto w) {
+            request::emplace("req-" + std::to_string(i));
+            retries::emplace(i);
+            timeouts::emplace(-i);
+
+            bool ok = true;
+
+            for (int n = 0; n < 10; n++)
+            {
+                w.reschedule();
+                ok &= request::get()->id == "req-" + std::to_string(i);
+                ok &= *retries::get() == i && *timeouts::get() == -i;
+                (*retries::get())++;
+                retries::emplace(i);
+            }
+
+            return ok;
+        }));
+    }
+
+    c.reschedule();
+    check(s_alive == 8, "values of running coroutines");
+
+    bool ok = true;
+    for (auto& w : workers)
+    {
+        ok &= w.await();
+    }
+
+    check(ok, "every coroutine sees its own values");
+    check(s_alive == 0, "values destroyed when coroutines finish");
+    check(request::get() == nullptr, "caller has no value");
+}
+
+// canceled coroutines destroy their values too
+static void check_cancel(aio::coro<>& c)
+{
+    aio::event never;
+
+    auto unwound = aio::coro<>::start("unwound", [&](auto) {
+        request::emplace("unwound");
+        (void)never.wait();
+    });
+    auto errors = aio::coro<>::start("errors", [&](auto e) {
+        e.set_cancel_errors();
+        request::emplace("errors");
+        (void)never.wait();
+    });
+
+    unwound.set_cancel_throws();
+    c.reschedule();
+    check(s_alive == 2, "values of waiting coroutines");
+
+    unwound.cancel();
+    errors.cancel();
+    (void)unwound.try_await();
+    (void)errors.try_await();
+    check(s_alive == 0, "values destroyed by cancellation");
+}
+
+static void check_reentrant()
+{
+    auto c = aio::coro<bool>::start("reentrant", [](auto) {
+        late::emplace();
+        // replacing the value runs the destructor setting the other slot
+        late::emplace();
+        return last::get() && last::get()->size() == 1000;
+    });
+
+    check(c.await(), "destructor setting another slot");
+}
+
+static void main_coro(aio::coro<> c)
+{
+    check_concurrent(c);
+    check_cancel(c);
+    check_reentrant();
+
+    aio::scheduler::stop();
+}
+
+int main()
+{
+    aio::scheduler::setup_signal_handlers();
+
+    aio::coro<>::start("main", main_coro);
+
+    aio::scheduler::run();
+
+    return s_failed ? 1 : 0;
+}
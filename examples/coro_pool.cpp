@@ -0,0 +1,241 @@
+/* SPDX-License-Identifier: LGPL-2.1-or-later */
+
+#include <async/coro.hpp>
+#include <async/coro_pool.hpp>
+#include <async/event.hpp>
+#include <async/impl/this_coro.hpp>
+#include <async/scheduler.hpp>
+#include <boost/asio/steady_timer.hpp>
+
+#include <optional>
+#include <stdexcept>
+#include <vector>
+
+namespace aio = async;
+
+static bool s_failed = false;
+
+static void check(bool ok, const char* what)
+{
+    printf("%s: %s\n", what, ok ? "ok" : "FAILED");
+    s_failed |= !ok;
+}
+
+// let the started coroutines run up to their suspension points
+static void settle(aio::coro<>& c)
+{
+    for (int i = 0; i < 10; i++)
+    {
+        c.reschedule();
+    }
+}
+
+static void sleep(std::chrono::milliseconds duration)
+{
+    boost::asio::steady_timer timer(aio::impl::io::get_executor());
+    timer.expires_after(duration);
+    timer.async_wait(aio::this_coro);
+}
+
+// several coroutines submit jobs and wait for the results at once
+static void check_concurrent(aio::coro<>& c)
+{
+    aio::coro_pool pool("pool", {.min_size = 1, .max_size = 4});
+    aio::event go;
+    std::vector<aio::coro<int>> clients;
+
+    for (int i = 0; i < 8; i++)
+    {
+        clients.push_back(aio::coro<int>::start("client", [&, i](auto) {
+            std::vector<aio::pool_result<int>> results;
+
+            for (int n = 0; n < 10; n++)
+            {
+                results.push_back(pool.submit([&go, i, n] {
+                    return go.wait() ? i * 100 + n : -1;
+                }));
+            }
+
+            int sum = 0;
+            for (auto& r : results)
+            {
+                sum += r.await();
+            }
+            return sum;
+        }));
+    }
+
+    settle(c);
+    check(pool.size() == 4 && pool.idle() == 0, "workers limited to max_size");
+    go.set();
+
+    bool ok = true;
+    for (int i = 0; i < 8; i++)
+    {
+        ok &= clients[i].await() == i * 1000 + 45;
+    }
+
+    check(ok, "concurrent submits");
+}
+
+// jobs submitted back to back find the woken workers busy
+static void check_blocking(aio::coro<>& c)
+{
+    aio::coro_pool pool("pool", {.min_size = 1, .max_size = 8});
+    aio::event go;
+    std::vector<aio::pool_result<bool>> results;
+
+    settle(c);
+
+    for (int i = 0; i < 5; i++)
+    {
+        results.push_back(pool.submit([&] { return go.wait(); }));
+    }
+
+    settle(c);
+    check(pool.size() == 5 && pool.idle() == 0, "every blocking job gets a worker");
+
+    go.set();
+
+    bool ok = true;
+    for (auto& r : results)
+    {
+        ok &= r.await();
+    }
+    check(ok, "blocking jobs complete");
+}
+
+static void check_exception()
+{
+    aio::coro_pool pool("pool");
+
+    auto failing = pool.submit([]() -> int { throw std::runtime_error("failed"); });
+    auto next = pool.submit([] { return 7; });
+
+    bool thrown = false;
+    try
+    {
+        failing.await();
+    }
+    catch (const std::runtime_error&)
+    {
+        thrown = true;
+    }
+
+    check(thrown, "exception is rethrown by await");
+    check(next.await() == 7, "worker survives the exception");
+}
+
+// the awaiter is canceled, not the job
+static void check_cancel(aio::coro<>& c)
+{
+    aio::coro_pool pool("pool");
+    aio::event go;
+
+    auto job = pool.submit([&] { return go.wait() ? 7 : 0; });
+
+    auto waiter = aio::coro<bool>::start("waiter", [&](auto w) {
+        w.set_cancel_errors();
+        try
+        {
+            job.await();
+        }
+        catch (const aio::exception::canceled&)
+        {
+            return true;
+        }
+        return false;
+    });
+
+    settle(c);
+    waiter.cancel();
+    check(waiter.await(), "canceled awaiter throws canceled");
+
+    go.set();
+    check(job.await() == 7, "job keeps running");
+}
+
+// queued jobs fail when the pool goes away, running ones complete
+static void check_destroy(aio::coro<>& c)
+{
+    aio::event go;
+    std::optional<aio::pool_result<bool>> running;
+    std::optional<aio::pool_result<int>> queued;
+
+    {
+        aio::coro_pool pool("pool", {.min_size = 1, .max_size = 1});
+
+        running = pool.submit([&] { return go.wait(); });
+        queued = pool.submit([] { return 1; });
+        settle(c);
+    }
+
+    bool canceled = false;
+    try
+    {
+        queued->await();
+    }
+    catch (const aio::exception::canceled&)
+    {
+        canceled = true;
+    }
+    check(canceled, "queued job fails on destruction");
+
+    go.set();
+    check(running->await(), "running job completes after destruction");
+}
+
+// workers idle for the whole timeout are stopped down to min_size
+static void check_shrink(aio::coro<>& c)
+{
+    using namespace std::chrono_literals;
+
+    aio::coro_pool pool("pool", {.min_size = 1, .max_size = 8, .idle_timeout = 20ms});
+    aio::event go;
+    std::vector<aio::pool_result<bool>> results;
+
+    settle(c);
+
+    for (int i = 0; i < 4; i++)
+    {
+        results.push_back(pool.submit([&] { return go.wait(); }));
+    }
+
+    go.set();
+    for (auto& r : results)
+    {
+        (void)r.await();
+    }
+    settle(c);
+
+    check(pool.size() == 4 && pool.idle() == 4, "workers idle after the burst");
+
+    sleep(100ms);
+    settle(c);
+
+    check(pool.size() == 1, "idle workers stopped");
+    check(pool.submit([] { return 3; }).await() == 3, "pool works after shrinking");
+}
+
+static void main_coro(aio::coro<> c)
+{
+    check_concurrent(c);
+    check_blocking(c);
+    check_exception();
+    check_cancel(c);
+    check_destroy(c);
+    check_shrink(c);
+
+    aio::scheduler::stop();
+}
+
+int main()
+{
+    aio::scheduler::setup_signal_handlers();
+
+    aio::coro<>::start("main", main_coro);
+
+    aio::scheduler::run();
+
+    return s_failed ? 1 : 0;
+}
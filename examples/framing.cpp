@@ -0,0 +1,157 @@
+/* SPDX-License-Identifier: LGPL-2.1-or-later */
+
+#include <async/framing.hpp>
+
+#include <algorithm>
+#include <cstdio>
+#include <cstring>
+#include <string>
+#include <vector>
+
+namespace aio = async;
+
+static bool s_failed = false;
+
+static void check(bool ok, const char* what)
+{
+    printf("%s: %s\n", what, ok ? "ok" : "FAILED");
+    s_failed |= !ok;
+}
+
+/**
+ * @brief Feed the stream in pieces of the step size, collecting the frames.
+ *
+ * Stops at the first error other than would_block.
+ */
+static aio::error_code decode(aio::frame_decoder& decoder, const std::string& stream,
+                              std::size_t step, std::vector<std::string>& frames)
+{
+    std::optional<aio::read_buffer> frame;
+
+    for (std::size_t pos = 0; pos < stream.size();)
+    {
+        auto space = decoder.prepare();
+        auto size = std::min({step, space.size(), stream.size() - pos});
+
+        std::memcpy(space.data(), stream.data() + pos, size);
+        decoder.commit(size);
+        pos += size;
+
+        aio::error_code ec;
+
+        while (!(ec = decoder.next(frame)))
+        {
+            frames.emplace_back(frame->data(), frame->size());
+        }
+
+        if (ec != boost::asio::error::would_block)
+        {
+            return ec;
+        }
+    }
+
+    return {};
+}
+
+static std::string varint(std::size_t length)
+{
+    std::string prefix;
+
+    do
+    {
+        prefix += static_cast<char>((length & 0x7f) | (length > 0x7f ? 0x80 : 0));
+        length >>= 7;
+    } while (length);
+
+    return prefix;
+}
+
+static std::string big_endian(std::size_t length, std::size_t width)
+{
+    std::string prefix(width, '\0');
+
+    for (std::size_t i = 0; i < width; i++)
+    {
+        prefix[width - i - 1] = static_cast<char>(length >> (8 * i));
+    }
+
+    return prefix;
+}
+
+// frames of every size up to a couple of chunks, split at every step
+static void check_boundaries(const char* what, aio::framing framing, auto encode)
+{
+    std::vector<std::string> payloads;
+    std::string stream;
+
+    for (std::size_t size : {0, 1, 2, 127, 128, 300, 4095, 4096, 4097, 10000})
+    {
+        payloads.emplace_back(size, static_cast<char>('a' + payloads.size()));
+        stream += encode(payloads.back());
+    }
+
+    bool ok = true;
+
+    for (auto step : std::initializer_list<std::size_t>{1, 2, 3, 7, 64, 4096, stream.size()})
+    {
+        aio::frame_decoder decoder(framing, 4096);
+        std::vector<std::string> frames;
+
+        ok &= !decode(decoder, stream, step, frames) && frames == payloads;
+    }
+
+    check(ok, what);
+}
+
+int main()
+{
+    check_boundaries("varint frames", aio::framing::varint(),
+                     [](const std::string& p) { return varint(p.size()) + p; });
+
+    for (std::size_t width : {2, 4, 8})
+    {
+        check_boundaries("fixed frames", aio::framing::fixed(width),
+                         [=](const std::string& p) { return big_endian(p.size(), width) + p; });
+    }
+
+    // delimiter split between the receives, and the scan resumed
+    check_boundaries("delimited frames", aio::framing::delimiter("\r\n"),
+                     [](const std::string& p) { return p + "\r\n"; });
+
+    std::vector<std::string> frames;
+
+    {
+        aio::frame_decoder decoder(aio::framing::varint(1000));
+        auto ec = decode(decoder, varint(1001) + std::string(1001, 'x'), 1, frames);
+        check(ec == boost::asio::error::message_size, "varint frame over the limit");
+    }
+
+    {
+        // 2^64 would wrap to an empty frame
+        aio::frame_decoder decoder(aio::framing::varint());
+        auto ec = decode(decoder, std::string(9, '\x80') + '\x02' + "x", 1, frames);
+        check(ec == boost::asio::error::invalid_argument, "overflowing varint");
+    }
+
+    {
+        aio::frame_decoder decoder(aio::framing::varint());
+        auto ec = decode(decoder, std::string(10, '\x80') + '\x00', 1, frames);
+        check(ec == boost::asio::error::invalid_argument, "varint longer than 10 bytes");
+    }
+
+    {
+        aio::frame_decoder decoder(aio::framing::varint());
+        auto ec = decode(decoder, std::string(9, '\xff') + '\x01', 1, frames);
+        check(ec == boost::asio::error::message_size, "largest varint");
+    }
+
+    {
+        aio::frame_decoder decoder(aio::framing::delimiter("\n", 100));
+        auto ec = decode(decoder, std::string(200, 'x'), 7, frames);
+        check(ec == boost::asio::error::message_size, "delimited frame over the limit");
+    }
+
+    check(frames.empty(), "no frames from invalid streams");
+
+    return s_failed ? 1 : 0;
+}
@@ -14,7 +14,10 @@ static aio::sema s_sema2;
 static void do_locked(aio::coro<void> c)
 {
     printf("%s: start\n", c.name().data());
-    s_sema.lock();
+    if (!s_sema.lock())
+    {
+        return;
+    }
     printf("%s: has lock\n", c.name().data());
     s_sema.unlock();
 }
@@ -22,7 +25,10 @@ static void do_locked(aio::coro<void> c)
 static void do_locked2(aio::coro<void> c)
 {
     printf("%s: start\n", c.name().data());
-    s_sema2.lock();
+    if (!s_sema2.lock())
+    {
+        return;
+    }
     printf("%s: has lock\n", c.name().data());
     s_sema2.unlock();
 }
@@ -30,8 +36,10 @@ static void do_locked2(aio::coro<void> c)
 static void main_coro(aio::coro<> c)
 {
     printf("%s: start\n", c.name().data());
-    s_sema.lock();
-    s_sema2.lock();
+    if (!s_sema.lock() || !s_sema2.lock())
+    {
+        return;
+    }
 
     auto c1 = aio::coro<void>::start("do1", do_locked);
     auto c2 = aio::coro<void>::start("do2", do_locked2);
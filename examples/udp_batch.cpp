@@ -0,0 +1,119 @@
+/* SPDX-License-Identifier: LGPL-2.1-or-later */
+
+#include <async/coro.hpp>
+#include <async/scheduler.hpp>
+#include <async/udp.hpp>
+
+#include <cstring>
+#include <string_view>
+
+namespace aio = async;
+
+static bool s_failed = false;
+
+static void check(bool ok, const char* what)
+{
+    printf("%s: %s\n", what, ok ? "ok" : "FAILED");
+    s_failed |= !ok;
+}
+
+static aio::shared_buffer make_buffer(std::string_view data, std::size_t size = 64)
+{
+    aio::shared_buffer buffer(std::make_shared<char[]>(size), 0, size);
+
+    std::memcpy(buffer.write_ptr(), data.data(), data.size());
+    buffer.commit(data.size());
+    return buffer;
+}
+
+static std::string_view view(const aio::shared_buffer& buffer)
+{
+    return {buffer.read_ptr(), buffer.avail_read()};
+}
+
+static aio::udp::socket bind_loopback()
+{
+    aio::udp::socket sock(aio::udp::endpoint(aio::udp::address_v4::loopback(), 0));
+    return sock;
+}
+
+static void main_coro(aio::coro<> c)
+{
+    auto a = bind_loopback();
+    auto b = bind_loopback();
+    auto peer = bind_loopback();
+    auto a_ep = a.boost_socket().local_endpoint();
+    auto peer_ep = peer.boost_socket().local_endpoint();
+
+    std::vector<aio::shared_buffer> received;
+    std::vector<aio::udp::endpoint> senders;
+    std::size_t count = 0;
+
+    received.push_back(make_buffer({}));
+    received.push_back(make_buffer({}));
+
+    // receiver waits for readiness while the same socket sends a batch
+    auto receiver = aio::coro<aio::error_code>::start("receiver", [&](auto) {
+        return a.async_receive_batch(received, senders, count);
+    });
+
+    c.reschedule();
+
+    std::vector<aio::shared_buffer> sent;
+    std::vector<aio::udp::endpoint> peers{peer_ep, peer_ep};
+    std::size_t sent_count = 0;
+
+    sent.push_back(make_buffer("CONSTDATA"));
+    sent.push_back(make_buffer("MOREDATA"));
+
+    auto ec = a.async_send_batch(sent, peers, sent_count);
+    check(!ec && sent_count == 2, "send batch while receiving");
+
+    std::size_t n = 0;
+    ec = b.async_send_to(aio::udp::socket::const_buffer("hello-from-b", 12), a_ep, n);
+    check(!ec && n == 12, "send to the receiver");
+
+    ec = receiver.await();
+    check(!ec && count == 1 && view(received[0]) == "hello-from-b", "receive batch");
+    check(senders[0] == b.boost_socket().local_endpoint(), "receive batch sender");
+    check(view(sent[0]) == "CONSTDATA" && view(sent[1]) == "MOREDATA", "send buffers intact");
+
+    std::vector<aio::shared_buffer> forwarded;
+    forwarded.push_back(make_buffer({}));
+    forwarded.push_back(make_buffer({}));
+
+    ec = peer.async_receive_batch(forwarded, count);
+    check(!ec && count == 2 && view(forwarded[0]) == "CONSTDATA" &&
+              view(forwarded[1]) == "MOREDATA",
+          "peer receives the batch");
+
+    // canceled receiver returns the error instead of waiting forever
+    std::vector<aio::shared_buffer> pending;
+    pending.push_back(make_buffer({}));
+
+    auto waiting = aio::coro<aio::error_code>::start_lazy("waiting", [&](auto w) {
+        w.set_cancel_errors();
+        return a.async_receive_batch(pending, count);
+    });
+
+    waiting.run();
+    c.reschedule();
+    waiting.cancel();
+
+    auto r = waiting.try_await();
+    check(r && *r == boost::asio::error::operation_aborted && pending[0].avail_read() == 0,
+          "canceled receive batch");
+
+    aio::scheduler::stop();
+}
+
+int main()
+{
+    aio::scheduler::setup_signal_handlers();
+
+    aio::coro<>::start("main", main_coro);
+
+    aio::scheduler::run();
+
+    return s_failed ? 1 : 0;
+}
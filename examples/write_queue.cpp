@@ -0,0 +1,168 @@
+/* SPDX-License-Identifier: LGPL-2.1-or-later */
+
+#include <async/coro.hpp>
+#include <async/scheduler.hpp>
+#include <async/write_queue.hpp>
+
+#include <cstring>
+#include <map>
+
+namespace aio = async;
+
+static bool s_failed = false;
+
+static void check(bool ok, const char* what)
+{
+    printf("%s: %s\n", what, ok ? "ok" : "FAILED");
+    s_failed |= !ok;
+}
+
+struct record
+{
+    std::uint32_t producer;
+    std::uint32_t seq;
+};
+
+static aio::shared_buffer make_record(std::uint32_t producer, std::uint32_t seq)
+{
+    record r{producer, seq};
+    aio::shared_buffer buffer(std::make_shared<char[]>(sizeof(r)), 0, sizeof(r));
+
+    std::memcpy(buffer.write_ptr(), &r, sizeof(r));
+    buffer.commit(sizeof(r));
+    return buffer;
+}
+
+static bool read_exact(aio::tcp::socket& sock, char* data, std::size_t size)
+{
+    std::size_t n;
+
+    for (std::size_t done = 0; done < size; done += n)
+    {
+        if (sock.async_receive(aio::tcp::socket::mutable_buffer(data + done, size - done), n))
+        {
+            return false;
+        }
+    }
+
+    return true;
+}
+
+static constexpr std::size_t blob_size = 16 * 1024 * 1024;
+static constexpr std::uint32_t producers = 4;
+static constexpr std::uint32_t records = 1000;
+
+// check that the records of every producer arrive whole and in order
+static bool read_records(aio::tcp::socket& sock)
+{
+    static char blob[blob_size];
+    std::map<std::uint32_t, std::uint32_t> next;
+    record r;
+
+    if (!read_exact(sock, blob, blob_size))
+    {
+        return false;
+    }
+
+    while (read_exact(sock, reinterpret_cast<char*>(&r), sizeof(r)))
+    {
+        if (r.seq != next[r.producer]++)
+        {
+            return false;
+        }
+    }
+
+    next.erase(99);
+
+    return next.size() == producers &&
+           std::ranges::all_of(next, [](const auto& item) { return item.second == records; });
+}
+
+static void main_coro(aio::coro<> c)
+{
+    aio::tcp::endpoint ep(aio::tcp::address_v4::loopback(), 34582);
+    aio::tcp::acceptor acceptor(ep, true);
+    acceptor.listen();
+
+    aio::tcp::socket sock;
+    aio::tcp::socket peer;
+
+    check(!sock.async_connect(ep) && !acceptor.async_accept(peer), "connect");
+
+    aio::tcp::write_queue queue(sock, 64 * 1024);
+
+    // the peer does not read yet, the producer waits for the queue space
+    auto blocked = aio::coro<aio::error_code>::start_lazy("blocked", [&](auto b) {
+        b.set_cancel_errors();
+        return queue.push(aio::shared_buffer(std::make_shared<char[]>(blob_size), blob_size,
+                                             blob_size));
+    });
+
+    blocked.run();
+    c.reschedule();
+    blocked.cancel();
+
+    auto r = blocked.try_await();
+    check(r && *r == boost::asio::error::operation_aborted, "canceled producer");
+
+    auto unwound = aio::coro<>::start_lazy("unwound", [&](auto) {
+        (void)queue.push(make_record(99, 0));
+    });
+
+    unwound.set_cancel_throws();
+    unwound.run();
+    c.reschedule();
+    unwound.cancel();
+    check(!unwound.try_await(), "unwound producer");
+
+    // other producers are not affected by the cancellations
+    auto reader = aio::coro<bool>::start("reader", [&](auto) {
+        return read_records(peer);
+    });
+
+    std::vector<aio::coro<aio::error_code>> writers;
+
+    for (std::uint32_t p = 0; p < producers; p++)
+    {
+        writers.push_back(aio::coro<aio::error_code>::start("producer", [&, p](auto w) {
+            for (std::uint32_t i = 0; i < records; i++)
+            {
+                if (auto ec = queue.push(make_record(p, i)))
+                {
+                    return ec;
+                }
+
+                if (i % 16 == 0)
+                {
+                    w.reschedule();
+                }
+            }
+            return aio::error_code{};
+        }));
+    }
+
+    bool pushed = true;
+    for (auto& w : writers)
+    {
+        pushed &= !w.await();
+    }
+
+    check(pushed, "concurrent producers");
+    check(!queue.flush() && queue.queued() == 0, "flush");
+
+    sock.close();
+    check(reader.await(), "records arrive in order");
+
+    aio::scheduler::stop();
+}
+
+int main()
+{
+    aio::scheduler::setup_signal_handlers();
+
+    aio::coro<>::start("main", main_coro);
+
+    aio::scheduler::run();
+
+    return s_failed ? 1 : 0;
+}
@@ -0,0 +1,136 @@
+/* SPDX-License-Identifier: LGPL-2.1-or-later */
+
+#include <async/coro.hpp>
+#include <async/scheduler.hpp>
+#include <async/socket.hpp>
+
+#include <cstring>
+
+namespace aio = async;
+
+static bool s_failed = false;
+
+static void check(bool ok, const char* what)
+{
+    printf("%s: %s\n", what, ok ? "ok" : "FAILED");
+    s_failed |= !ok;
+}
+
+static aio::shared_buffer make_buffer(std::size_t size, char fill)
+{
+    aio::shared_buffer buffer(std::make_shared<char[]>(size), size, size);
+
+    std::memset(const_cast<char*>(buffer.read_ptr()), fill, size);
+    return buffer;
+}
+
+// receive the connection until eof, the data is checked against the fill
+static std::size_t drain(aio::tcp::socket& sock, char fill)
+{
+    static char data[64 * 1024];
+    std::size_t total = 0;
+    std::size_t n;
+
+    while (!sock.async_receive(aio::tcp::socket::mutable_buffer(data, sizeof(data)), n))
+    {
+        if (std::memchr(data, fill ^ 1, n))
+        {
+            return 0;
+        }
+        total += n;
+    }
+
+    return total;
+}
+
+// send buffers while another coroutine reaps them
+static void send_and_reap(aio::tcp::socket& sock, const char* what)
+{
+    constexpr std::size_t count = 4;
+    constexpr std::size_t size = 256 * 1024;
+    std::vector<aio::shared_buffer> reaped;
+
+    auto reaper = aio::coro<aio::error_code>::start_lazy("reaper", [&](auto r) {
+        aio::error_code ec;
+
+        while (!ec && reaped.size() < count)
+        {
+            if (!sock.zerocopy_pending())
+            {
+                r.reschedule();
+            }
+            ec = sock.async_reap_zerocopy(reaped);
+        }
+        return ec;
+    });
+
+    bool sent = true;
+
+    for (std::size_t i = 0; i < count; i++)
+    {
+        std::size_t n;
+        sent &= !sock.async_send_zerocopy(make_buffer(size, 'z'), n) && n == size;
+        reaper.run();
+    }
+
+    check(sent && !reaper.await() && reaped.size() == count, what);
+}
+
+static void main_coro(aio::coro<> c)
+{
+    aio::tcp::endpoint ep(aio::tcp::address_v4::loopback(), 34581);
+    aio::tcp::acceptor acceptor(ep, true);
+    acceptor.listen();
+
+    aio::tcp::socket sock;
+    aio::tcp::socket peer;
+
+    check(!sock.async_connect(ep) && !acceptor.async_accept(peer), "connect");
+
+    // sender canceled while the peer does not read
+    auto blocked = aio::coro<aio::error_code>::start_lazy("blocked", [&](auto b) {
+        std::size_t sent;
+        b.set_cancel_errors();
+        return sock.async_send_zerocopy(make_buffer(64 * 1024 * 1024, 'z'), sent);
+    });
+
+    blocked.run();
+    c.reschedule();
+    blocked.cancel();
+
+    auto r = blocked.try_await();
+    check(r && *r == boost::asio::error::operation_aborted, "canceled zerocopy send");
+    check(sock.zerocopy_pending() == 1, "canceled send keeps its buffer");
+
+    // the buffer is released with the socket
+    sock.close();
+    peer.close();
+    check(sock.zerocopy_pending() == 0, "close releases buffers");
+
+    for (auto what : {"send and reap", "send and reap after reopen"})
+    {
+        check(!sock.async_connect(ep) && !acceptor.async_accept(peer), "connect");
+
+        auto reader = aio::coro<std::size_t>::start("reader", [&](auto) {
+            return drain(peer, 'z');
+        });
+
+        send_and_reap(sock, what);
+        sock.close();
+        check(reader.await() == 4 * 256 * 1024, "peer receives the data");
+        peer.close();
+    }
+
+    aio::scheduler::stop();
+}
+
+int main()
+{
+    aio::scheduler::setup_signal_handlers();
+
+    aio::coro<>::start("main", main_coro);
+
+    aio::scheduler::run();
+
+    return s_failed ? 1 : 0;
+}
@@ -0,0 +1,90 @@
+/* SPDX-License-Identifier: LGPL-2.1-or-later */
+
+#pragma once
+
+#include <async/impl/wait_queue.hpp>
+#include <async/socket.hpp>
+#include <boost/asio/steady_timer.hpp>
+
+#include <chrono>
+#include <deque>
+#include <map>
+
+namespace async::tcp
+{
+
+/**
+ * @brief Pool of outbound connections keyed by the endpoint.
+ */
+struct connection_pool
+{
+    using clock = std::chrono::steady_clock;
+    using timer_type = boost::asio::basic_waitable_timer<clock, boost::asio::wait_traits<clock>,
+                                                         impl::io_executor>;
+
+    struct options
+    {
+        // connections handed out or connecting, per endpoint
+        std::size_t max_active = 16;
+        // idle connections are closed after this time
+        clock::duration idle_timeout = std::chrono::seconds(60);
+    };
+
+    connection_pool();
+    connection_pool(options);
+    connection_pool(const connection_pool&) = delete;
+    ~connection_pool();
+
+    /**
+     * @brief Get connected socket.
+     *
+     * Reuses the most recently released idle connection if it is still
+     * alive, otherwise connects a new one. Suspends the coroutine while the
+     * endpoint has max_active connections handed out.
+     */
+    error_code acquire(const endpoint&, socket&);
+
+    /**
+     * @brief Return acquired socket to the pool.
+     *
+     * The socket is closed if reuse is false, e.g. after a protocol error.
+     */
+    void release(const endpoint&, socket&&, bool reuse = true);
+
+    /**
+     * @brief Close connections idle for longer than the timeout.
+     */
+    void evict_idle();
+
+    /**
+     * @brief Number of idle connections to the endpoint.
+     */
+    std::size_t idle(const endpoint&) const;
+
+  private:
+    struct idle_socket
+    {
+        socket s;
+        clock::time_point since;
+    };
+
+    struct entry
+    {
+        std::deque<idle_socket> idle;
+        std::size_t active = 0;
+        // coroutines inside acquire(), possibly suspended
+        std::size_t acquiring = 0;
+        impl::wait_queue::head waiters;
+    };
+
+    static bool alive(socket&);
+    void arm_timer();
+
+  private:
+    options _options;
+    std::map<endpoint, entry> _entries;
+    timer_type _timer;
+    bool _timer_armed = false;
+};
+
+} // namespace async::tcp
@@ -2,8 +2,11 @@
 
 #pragma once
 
+#include <async/error_code.hpp>
 #include <async/exceptions.hpp>
 #include <async/impl/coro_impl.hpp>
+#include <async/impl/freelist.hpp>
+#include <boost/asio/error.hpp>
 
 #include <expected>
 
@@ -19,6 +22,18 @@ struct coro;
 template <typename Function, typename R, typename... Args>
 concept coro_func_t = std::is_invocable_r_v<R, Function, coro<R>, Args...>;
 
+/**
+ * @brief Failure of the awaited coroutine.
+ *
+ * Either the exception thrown by the coroutine, or operation_aborted code
+ * if it, or the waiting coroutine, has been canceled.
+ */
+struct coro_error
+{
+    error_code code;
+    std::exception_ptr exception;
+};
+
 /**
  * @brief Class for coroutines.
  */
@@ -67,6 +82,22 @@ struct coro
         return get_ptr()->cancel_throws();
     }
 
+    /**
+     * @brief check if cancel is reported by error codes.
+     */
+    bool cancel_errors() const
+    {
+        return get_ptr()->cancel_errors();
+    }
+
+    /**
+     * @brief get runtime statistics of the coroutine.
+     */
+    coro_stats stats() const
+    {
+        return get_ptr()->stats();
+    }
+
     /**
      * @brief cancel coroutine.
      */
@@ -83,6 +114,19 @@ struct coro
         return get_ptr()->set_cancel_throws(cancel_throws);
     }
 
+    /**
+     * @brief report cancel by error codes instead of exceptions.
+     *
+     * The canceled coroutine is resumed, and the current and every
+     * following suspension point returns at once: asynchronous operations
+     * complete with operation_aborted, waits return false. Pending
+     * operations are not canceled, the caller should close the I/O objects.
+     */
+    void set_cancel_errors(bool cancel_errors = true) const
+    {
+        return get_ptr()->set_cancel_errors(cancel_errors);
+    }
+
     /**
      * @brief asynchronously wait for result.
      */
@@ -90,7 +134,10 @@ struct coro
     {
         auto ptr = get_ptr();
 
-        impl::coro_base::await(ptr);
+        if (!impl::coro_base::await(ptr))
+        {
+            throw exception::canceled();
+        }
 
         if constexpr (is_void_result)
         {
@@ -102,6 +149,42 @@ struct coro
         }
     }
 
+    /**
+     * @brief asynchronously wait for result without throwing exceptions.
+     *
+     * Returns operation_aborted if the waiting coroutine is canceled in
+     * error mode, or the target was canceled in throw mode. A target
+     * canceled in error mode returns its own result.
+     */
+    std::expected<R, coro_error> try_await() const
+    {
+        auto ptr = get_ptr();
+
+        if (!impl::coro_base::await(ptr))
+        {
+            return std::unexpected(coro_error{boost::asio::error::operation_aborted, nullptr});
+        }
+
+        if (ptr->has_exception())
+        {
+            return std::unexpected(coro_error{{}, ptr->get_exception()});
+        }
+
+        if (ptr->canceled() && ptr->cancel_throws())
+        {
+            return std::unexpected(coro_error{boost::asio::error::operation_aborted, nullptr});
+        }
+
+        if constexpr (is_void_result)
+        {
+            return {};
+        }
+        else
+        {
+            return ptr->take_result();
+        }
+    }
+
     /**
      * @brief yield execution with the specified result.
      */
@@ -133,32 +216,57 @@ struct coro
         impl::coro_base::reschedule(get_ptr());
     }
 
+    /**
+     * @brief start a lazily created coroutine, no-op if already started.
+     */
+    void run() const
+    {
+        impl::coro_base::run(get_ptr());
+    }
+
     /**
      * @brief start a new coroutine.
      */
     template <typename... Args>
     static coro start(std::string name, coro_func_t<R, Args...> auto&& func, Args&&... args)
+    {
+        auto c = start_lazy(std::move(name), std::move(func), std::forward<Args>(args)...);
+        c.run();
+        return c;
+    }
+
+    /**
+     * @brief create a new coroutine without starting it.
+     *
+     * Only the function is stored, the stack is allocated by the first
+     * await() or run() call. The coroutine canceled before that is never
+     * started.
+     */
+    template <typename... Args>
+    static coro start_lazy(std::string name, coro_func_t<R, Args...> auto&& func, Args&&... args)
         requires(!is_void_result)
     {
         auto c = make_coro(std::move(name));
-        impl::coro_base::start(
-            c, [c, func = std::move(func), ... args = std::forward<Args>(args)] mutable {
-                c->set_result(func(c, std::forward<Args>(args)...));
+        impl::coro_base::start_lazy(
+            c, [func = std::move(func), ... args = std::forward<Args>(args)] mutable {
+                auto c = current();
+                c.set_result(func(c, std::forward<Args>(args)...));
             });
         return c;
     }
 
     /**
-     * @brief start a new coroutine.
+     * @brief create a new coroutine without starting it.
      */
     template <typename... Args>
-    static coro start(std::string name, coro_func_t<void, Args...> auto&& func, Args&&... args)
+    static coro start_lazy(std::string name, coro_func_t<void, Args...> auto&& func,
+                           Args&&... args)
         requires is_void_result
     {
         auto c = make_coro(std::move(name));
-        impl::coro_base::start(
-            c, [c, func = std::move(func), ... args = std::forward<Args>(args)] mutable {
-                func(c, std::forward<Args>(args)...);
+        impl::coro_base::start_lazy(
+            c, [func = std::move(func), ... args = std::forward<Args>(args)] mutable {
+                func(current(), std::forward<Args>(args)...);
             });
         return c;
     }
@@ -210,12 +318,25 @@ struct coro
     }
 
   private:
+    /**
+     * @brief get the running coroutine.
+     *
+     * The stored function doesn't own the coroutine to let never started
+     * coroutines be destroyed.
+     */
+    static coro current()
+    {
+        return coro(std::static_pointer_cast<impl::coro_impl<R>>(impl::coro_base::current_coro()));
+    }
+
     /**
      * @brief allocate and construct coroutine implemenation.
      */
     static impl_ptr make_coro(std::string&& name)
     {
-        return std::make_shared<impl::coro_impl<R>>(std::move(name));
+        // recycle the coroutine objects with the control block
+        return std::allocate_shared<impl::coro_impl<R>>(
+            impl::freelist_allocator<impl::coro_impl<R>>(), std::move(name));
     }
 
   private:
@@ -0,0 +1,51 @@
+/* SPDX-License-Identifier: LGPL-2.1-or-later */
+
+#pragma once
+
+#include <async/impl/coro_impl.hpp>
+
+namespace async
+{
+
+/**
+ * @brief Coroutine-local value of type T.
+ *
+ * Every coroutine has its own value, destroyed when the coroutine
+ * finishes. The slot index is allocated once per type and tag, so the
+ * lookup is an array access. Different tags give separate values of the
+ * same type.
+ */
+template <typename T, typename Tag = T>
+struct coro_local
+{
+    /**
+     * @brief get value of the current coroutine, nullptr if not set.
+     */
+    static T* get()
+    {
+        return static_cast<T*>(impl::coro_base::current_locals().get(index));
+    }
+
+    /**
+     * @brief construct value of the current coroutine.
+     */
+    template <typename... Args>
+    static T& emplace(Args&&... args)
+    {
+        return impl::coro_base::current_locals().template emplace<T>(index,
+                                                                     std::forward<Args>(args)...);
+    }
+
+    /**
+     * @brief destroy value of the current coroutine.
+     */
+    static void reset()
+    {
+        impl::coro_base::current_locals().reset(index);
+    }
+
+  private:
+    static inline const std::size_t index = impl::local_storage::next_index();
+};
+
+} // namespace async
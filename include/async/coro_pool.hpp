@@ -0,0 +1,176 @@
+/* SPDX-License-Identifier: LGPL-2.1-or-later */
+
+#pragma once
+
+#include <async/event.hpp>
+#include <async/exceptions.hpp>
+
+#include <chrono>
+#include <exception>
+#include <memory>
+#include <optional>
+#include <string>
+#include <type_traits>
+
+namespace async
+{
+
+namespace impl
+{
+
+struct pool_job
+{
+    virtual ~pool_job() = default;
+    virtual void run() = 0;
+    virtual void fail(std::exception_ptr) = 0;
+};
+
+template <typename R>
+struct pool_job_result : pool_job
+{
+    void fail(std::exception_ptr ex) override
+    {
+        _exception = ex;
+        _done.set();
+    }
+
+    R get()
+    {
+        if (!_done.wait())
+        {
+            throw exception::canceled();
+        }
+
+        if (_exception)
+        {
+            std::rethrow_exception(_exception);
+        }
+
+        if constexpr (!std::is_same_v<R, void>)
+        {
+            return std::move(*_result);
+        }
+    }
+
+  protected:
+    template <typename Function>
+    void complete(Function& func)
+    {
+        if constexpr (std::is_same_v<R, void>)
+        {
+            func();
+        }
+        else
+        {
+            _result.emplace(func());
+        }
+        _done.set();
+    }
+
+  private:
+    using result_type = std::conditional_t<std::is_same_v<R, void>, bool, R>;
+
+    std::optional<result_type> _result;
+    std::exception_ptr _exception;
+    event _done;
+};
+
+template <typename R, typename Function>
+struct pool_job_impl final : pool_job_result<R>
+{
+    pool_job_impl(Function&& func) : _func(std::move(func))
+    {}
+
+    void run() override
+    {
+        this->complete(_func);
+    }
+
+  private:
+    Function _func;
+};
+
+struct coro_pool_state;
+
+} // namespace impl
+
+/**
+ * @brief Result of a job submitted to the coroutine pool.
+ */
+template <typename R>
+struct pool_result
+{
+    /**
+     * @brief asynchronously wait for the job result.
+     */
+    R await() const
+    {
+        return _job->get();
+    }
+
+  private:
+    friend struct coro_pool;
+
+    pool_result(std::shared_ptr<impl::pool_job_result<R>> job) : _job(std::move(job))
+    {}
+
+  private:
+    std::shared_ptr<impl::pool_job_result<R>> _job;
+};
+
+/**
+ * @brief Pool of worker coroutines running submitted jobs.
+ *
+ * Workers are started on demand up to max_size and block on the job
+ * queue when idle. Workers staying idle for the whole idle_timeout are
+ * stopped, but no fewer than min_size are kept running.
+ */
+struct coro_pool
+{
+    using clock = std::chrono::steady_clock;
+
+    struct options
+    {
+        std::size_t min_size = 1;
+        std::size_t max_size = 64;
+        clock::duration idle_timeout = std::chrono::seconds(10);
+    };
+
+    coro_pool(std::string name);
+    coro_pool(std::string name, options);
+    coro_pool(const coro_pool&) = delete;
+    ~coro_pool();
+
+    /**
+     * @brief Queue the function to be run by a worker coroutine.
+     */
+    template <typename Function>
+    auto submit(Function&& func)
+    {
+        using func_type = std::decay_t<Function>;
+        using result_type = std::invoke_result_t<func_type&>;
+        using job_type = impl::pool_job_impl<result_type, func_type>;
+
+        auto job = std::make_shared<job_type>(func_type(std::forward<Function>(func)));
+        post(job);
+        return pool_result<result_type>(std::move(job));
+    }
+
+    /**
+     * @brief Number of running workers.
+     */
+    std::size_t size() const;
+
+    /**
+     * @brief Number of workers waiting for a job.
+     */
+    std::size_t idle() const;
+
+  private:
+    void post(std::shared_ptr<impl::pool_job>);
+
+  private:
+    std::shared_ptr<impl::coro_pool_state> _state;
+};
+
+} // namespace async
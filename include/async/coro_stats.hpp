@@ -0,0 +1,49 @@
+/* SPDX-License-Identifier: LGPL-2.1-or-later */
+
+#pragma once
+
+#include <chrono>
+#include <cstdint>
+#include <string>
+
+namespace async
+{
+
+/**
+ * @brief Runtime statistics of a coroutine.
+ *
+ * Collected only when built with ASYNC_CORO_STATS (the coro_stats meson
+ * option), otherwise all values stay zero.
+ */
+struct coro_stats
+{
+    using clock = std::chrono::steady_clock;
+
+    static constexpr bool enabled =
+#ifdef ASYNC_CORO_STATS
+        true;
+#else
+        false;
+#endif
+
+    // number of switches into the coroutine
+    std::uint64_t resumes = 0;
+    // time spent running on the coroutine stack
+    clock::duration cpu_time{};
+    // time from the suspension until made runnable again
+    clock::duration suspended_time{};
+    // time from being made runnable until actually running
+    clock::duration scheduling_delay{};
+};
+
+/**
+ * @brief Statistics of a coroutine in the scheduler snapshot.
+ */
+struct coro_stats_entry
+{
+    std::string name;
+    bool running = false;
+    coro_stats stats;
+};
+
+} // namespace async
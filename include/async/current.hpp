@@ -34,6 +34,14 @@ struct coro
         coro_ptr()->cancel();
     }
 
+    /**
+     * @brief Arena of the current coroutine, released when it finishes.
+     */
+    static std::pmr::memory_resource* arena()
+    {
+        return coro_ptr()->arena();
+    }
+
   private:
     static async::impl::coro_ptr coro_ptr()
     {
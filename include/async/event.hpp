@@ -11,14 +11,17 @@ struct event : private impl::signaled
 {
     using impl::signaled::signaled;
 
-    void wait()
+    /**
+     * @brief Wait for the event, false if canceled in error mode.
+     */
+    [[nodiscard]] bool wait()
     {
         if (is_signaled())
         {
-            return;
+            return true;
         }
 
-        signaled::wait();
+        return signaled::wait();
     }
 
     void set(bool wake_one = false)
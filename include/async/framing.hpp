@@ -0,0 +1,162 @@
+/* SPDX-License-Identifier: LGPL-2.1-or-later */
+
+#pragma once
+
+#include <async/error_code.hpp>
+#include <async/shared_buffer.hpp>
+#include <boost/asio/buffer.hpp>
+#include <boost/asio/error.hpp>
+
+#include <optional>
+#include <string>
+
+namespace async
+{
+
+/**
+ * @brief Rule splitting a byte stream into frames.
+ */
+struct framing
+{
+    enum class kind
+    {
+        varint,
+        fixed,
+        delimiter,
+    };
+
+    static constexpr std::size_t default_max_frame = 16 * 1024 * 1024;
+
+    /**
+     * @brief Frames prefixed with unsigned LEB128 payload length.
+     */
+    static framing varint(std::size_t max_frame = default_max_frame)
+    {
+        return {kind::varint, 0, false, {}, max_frame};
+    }
+
+    /**
+     * @brief Frames prefixed with 1, 2, 4 or 8 byte payload length.
+     */
+    static framing fixed(std::size_t width, bool big_endian = true,
+                         std::size_t max_frame = default_max_frame)
+    {
+        return {kind::fixed, width, big_endian, {}, max_frame};
+    }
+
+    /**
+     * @brief Frames terminated by the delimiter.
+     */
+    static framing delimiter(std::string delimiter, std::size_t max_frame = default_max_frame)
+    {
+        return {kind::delimiter, 0, false, std::move(delimiter), max_frame};
+    }
+
+    kind type;
+    std::size_t width;
+    bool big_endian;
+    std::string delim;
+    std::size_t max_frame;
+};
+
+namespace impl
+{
+
+/**
+ * @brief Find byte in the memory range, returns end if not found.
+ *
+ * Uses AVX2 when supported by the CPU, or SSE2 on x86-64.
+ */
+const char* find_byte(const char* begin, const char* end, char c);
+
+} // namespace impl
+
+/**
+ * @brief Frame decoder owning the receive buffer.
+ *
+ * Data is received straight into the buffer returned by prepare(), and
+ * frames are returned as read_buffer slices of it. The data is copied
+ * only when a frame does not fit into the rest of the current buffer.
+ */
+struct frame_decoder
+{
+    static constexpr std::size_t default_chunk = 64 * 1024;
+
+    frame_decoder(framing, std::size_t chunk = default_chunk);
+
+    /**
+     * @brief Get buffer space for receiving more data.
+     */
+    boost::asio::mutable_buffer prepare();
+
+    /**
+     * @brief Commit received data.
+     */
+    void commit(std::size_t);
+
+    /**
+     * @brief Extract next frame payload.
+     *
+     * Returns would_block if no complete frame is received yet,
+     * message_size if the frame is larger than the framing limit, or
+     * invalid_argument if the length prefix is malformed.
+     */
+    error_code next(std::optional<read_buffer>&);
+
+  private:
+    error_code parse_length(std::size_t&, std::size_t&) const;
+    bool find_delimiter(std::size_t&);
+    void reserve(std::size_t);
+
+  private:
+    framing _framing;
+    std::size_t _chunk;
+    std::optional<shared_buffer> _buffer;
+    // size of the next frame with prefix or delimiter, when known
+    std::size_t _needed = 0;
+    // delimiter scan position
+    std::size_t _scanned = 0;
+};
+
+/**
+ * @brief Stream adapter returning complete frames.
+ */
+template <typename Socket>
+struct frame_reader
+{
+    frame_reader(Socket& socket, framing f, std::size_t chunk = frame_decoder::default_chunk) :
+        _socket(socket), _decoder(std::move(f), chunk)
+    {}
+
+    /**
+     * @brief Read next frame, suspending only while it is incomplete.
+     */
+    error_code async_read_frame(std::optional<read_buffer>& frame)
+    {
+        while (true)
+        {
+            auto ec = _decoder.next(frame);
+
+            if (ec != boost::asio::error::would_block)
+            {
+                return ec;
+            }
+
+            std::size_t received;
+
+            ec = _socket.async_receive(_decoder.prepare(), received);
+            if (ec)
+            {
+                return ec;
+            }
+
+            _decoder.commit(received);
+        }
+    }
+
+  private:
+    Socket& _socket;
+    frame_decoder _decoder;
+};
+
+} // namespace async
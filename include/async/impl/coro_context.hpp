@@ -3,8 +3,11 @@
 #pragma once
 
 #include <async/impl/coro_impl.hpp>
+#include <async/stack_usage.hpp>
 #include <boost/context/fiber.hpp>
 
+#include <map>
+
 namespace async::impl
 {
 
@@ -25,6 +28,7 @@ struct coro_context
 
     void cancel();
     void resume();
+    std::size_t reclaim_stack(bool lazy_free);
     void suspend();
     void destroy();
     void do_finish();
@@ -46,11 +50,41 @@ struct coro_context
     {
         return _impl;
     }
+
+    coro_base* get_impl_ptr() const
+    {
+        return _impl.get();
+    }
     static coro_context* current()
     {
         return s_current;
     }
 
+    void* arena_buffer() const
+    {
+        return _stack.sp;
+    }
+
+    std::size_t arena_size() const
+    {
+        return _arena_size;
+    }
+
+    static void set_arena_size(std::size_t);
+
+    /**
+     * @brief Deepest stack use, if the stack was filled with the canary.
+     */
+    bool painted() const
+    {
+        return _painted;
+    }
+
+    std::size_t stack_used() const;
+
+    static void set_watermark(bool);
+    static std::map<std::string, stack_usage, std::less<>> finished_watermarks();
+
   public:
     static coro_context& create(coro_func&&);
 
@@ -63,9 +97,23 @@ struct coro_context
     coro_ptr _impl;
     // parent context
     coro_context* _parent_ctx = nullptr;
+    // stack of this coroutine
+    boost::context::stack_context _stack;
+    // approximate stack pointer of the suspended coroutine
+    const char* _suspended_sp = nullptr;
+    // number of resumes, and the number seen by the last reclaim pass
+    std::size_t _resumes = 0;
+    std::size_t _seen_resumes = 0;
+    bool _reclaimed = false;
+    // arena reserved above the stack
+    std::size_t _arena_size = 0;
+    // stack filled with the canary to measure the high-water mark
+    bool _painted = false;
 
   private:
     static inline coro_context* s_current = nullptr;
+    static inline std::size_t s_arena_size = 0;
+    static inline bool s_watermark = false;
 };
 
 } // namespace async::impl
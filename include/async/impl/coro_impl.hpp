@@ -2,11 +2,18 @@
 
 #pragma once
 
+#include <async/coro_stats.hpp>
+#include <async/stack_usage.hpp>
+#include <async/impl/local_storage.hpp>
 #include <boost/intrusive/list.hpp>
 
+#include <cstdint>
 #include <functional>
 #include <memory>
+#include <memory_resource>
+#include <optional>
 #include <string>
+#include <vector>
 
 namespace async::impl
 {
@@ -34,11 +41,17 @@ struct coro_base : details::list_hook
         // printf("%s: destroy coro\n", _name.data());
     }
 
-    const std::string& name()
+    const std::string& name() const
     {
         return _name;
     }
 
+    // unique, unlike the address of the recycled object
+    std::uint64_t id() const
+    {
+        return _id;
+    }
+
     bool running() const
     {
         return _state != state::done;
@@ -54,6 +67,23 @@ struct coro_base : details::list_hook
         return _cancel_throws;
     }
 
+    bool cancel_errors() const
+    {
+        return _cancel_errors;
+    }
+
+    // resumed by cancel() from a suspension point, not by the event
+    bool cancel_resumed() const
+    {
+        return _cancel_resumed;
+    }
+
+    // canceled coroutine no longer waits for the pending handlers
+    bool aborted() const
+    {
+        return _canceled && (_cancel_throws || _cancel_errors);
+    }
+
     bool has_exception() const
     {
         return !!_exception;
@@ -69,6 +99,11 @@ struct coro_base : details::list_hook
         _cancel_throws = enable;
     }
 
+    void set_cancel_errors(bool enable)
+    {
+        _cancel_errors = enable;
+    }
+
     void set_exception(std::exception_ptr ex)
     {
         _exception = ex;
@@ -78,21 +113,48 @@ struct coro_base : details::list_hook
 
     void cancel();
 
+    local_storage& locals()
+    {
+        return _locals;
+    }
+
+    std::pmr::memory_resource* arena();
+
+    coro_stats stats() const
+    {
+#ifdef ASYNC_CORO_STATS
+        return _stats;
+#else
+        return {};
+#endif
+    }
+
     std::shared_ptr<void> get_data(const std::type_info& info);
     void set_data(const std::type_info& info, std::shared_ptr<void>&&);
 
   public:
     static coro_ptr current_coro();
+    static local_storage& current_locals();
 
     static void start(const coro_ptr&, std::move_only_function<void()>&&);
-    static void await(coro_ptr);
+    static void start_lazy(const coro_ptr&, std::move_only_function<void()>&&);
+    static void run(const coro_ptr&);
+    static bool await(coro_ptr);
     static void yield(coro_ptr);
     static void reschedule(coro_ptr);
+    static std::size_t reclaim_stacks(bool lazy_free);
+    static std::vector<coro_stats_entry> snapshot_stats();
+    static std::vector<stack_usage> stack_watermarks();
 
   private:
     enum class state
     {
+        // started lazily, no stack yet
+        created,
+        // may be resumed by anyone, e.g. await() of the coroutine
         suspended,
+        // resumed only by the completion it waits for, or the cancellation
+        waiting,
         pending,
         running,
         ready,
@@ -114,20 +176,34 @@ struct coro_base : details::list_hook
 
   protected:
     static void check_coro(bool);
-    static void suspend(const coro_ptr&);
+    static bool suspend(const coro_ptr&);
     static void resume(const coro_ptr&);
     static void finish(coro_ptr);
 
   private:
     std::string _name;
+    std::uint64_t _id;
     coro_context* _ctx = nullptr;
     std::exception_ptr _exception = nullptr;
     coro_ptr _waiter;
+    // function of the coroutine not started yet
+    std::move_only_function<void()> _pending_func;
     state _state = state::suspended;
     bool _canceled = false;
     bool _cancel_throws = false;
+    bool _cancel_errors = false;
+    bool _cancel_resumed = false;
     std::shared_ptr<void> _data;
     const std::type_info* _data_info = nullptr;
+    local_storage _locals;
+    // released all at once when the coroutine finishes
+    std::optional<std::pmr::monotonic_buffer_resource> _arena;
+    // time the coroutine was made runnable
+    coro_stats::clock::time_point _pending_at;
+#ifdef ASYNC_CORO_STATS
+    coro_stats _stats;
+    coro_stats::clock::time_point _suspended_at;
+#endif
 };
 
 template <typename R>
@@ -147,6 +223,11 @@ struct coro_impl : coro_base
         return std::move(_r);
     }
 
+    R take_result()
+    {
+        return std::move(_r);
+    }
+
   private:
     R _r;
 };
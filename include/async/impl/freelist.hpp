@@ -0,0 +1,103 @@
+/* SPDX-License-Identifier: LGPL-2.1-or-later */
+
+#pragma once
+
+#include <cstddef>
+#include <memory>
+#include <new>
+
+namespace async::impl
+{
+
+/**
+ * @brief List of freed memory blocks of the same size and alignment.
+ *
+ * Not thread safe, like the rest of the scheduler. Cached blocks are
+ * never returned to the heap, so blocks freed during the static
+ * destruction are still handled.
+ */
+template <std::size_t Size, std::size_t Align>
+struct freelist
+{
+    static constexpr std::size_t max_cached = 1024;
+
+    static void* allocate()
+    {
+        if (auto n = s_head)
+        {
+            s_head = n->next;
+            s_count--;
+            return n;
+        }
+
+        return ::operator new(size, std::align_val_t(align));
+    }
+
+    static void deallocate(void* p)
+    {
+        if (s_count >= max_cached)
+        {
+            ::operator delete(p, size, std::align_val_t(align));
+            return;
+        }
+
+        s_head = new (p) node{s_head};
+        s_count++;
+    }
+
+  private:
+    struct node
+    {
+        node* next;
+    };
+
+    static constexpr std::size_t size = Size < sizeof(node) ? sizeof(node) : Size;
+    static constexpr std::size_t align = Align < alignof(node) ? alignof(node) : Align;
+
+    static inline node* s_head = nullptr;
+    static inline std::size_t s_count = 0;
+};
+
+/**
+ * @brief Allocator recycling single objects through the freelist.
+ */
+template <typename T>
+struct freelist_allocator
+{
+    using value_type = T;
+
+    freelist_allocator() = default;
+
+    template <typename U>
+    constexpr freelist_allocator(const freelist_allocator<U>&) noexcept
+    {}
+
+    T* allocate(std::size_t n)
+    {
+        if (n != 1)
+        {
+            return std::allocator<T>().allocate(n);
+        }
+
+        return static_cast<T*>(freelist<sizeof(T), alignof(T)>::allocate());
+    }
+
+    void deallocate(T* p, std::size_t n) noexcept
+    {
+        if (n != 1)
+        {
+            std::allocator<T>().deallocate(p, n);
+            return;
+        }
+
+        freelist<sizeof(T), alignof(T)>::deallocate(p);
+    }
+
+    template <typename U>
+    constexpr bool operator==(const freelist_allocator<U>&) const noexcept
+    {
+        return true;
+    }
+};
+
+} // namespace async::impl
@@ -18,19 +18,34 @@ struct handler_base
         return _coro->canceled();
     }
 
+    bool aborted() const
+    {
+        return _coro->aborted();
+    }
+
+    bool cancel_resumed() const
+    {
+        return _coro->cancel_resumed();
+    }
+
     auto get_coro() const
     {
         return _coro;
     }
 
+    const coro_base& coro() const
+    {
+        return *_coro;
+    }
+
     void resume() const
     {
         coro_base::resume(_coro);
     }
 
-    void suspend() const
+    bool suspend() const
     {
-        coro_base::suspend(_coro);
+        return coro_base::suspend(_coro);
     }
 
   private:
@@ -0,0 +1,94 @@
+/* SPDX-License-Identifier: LGPL-2.1-or-later */
+
+#pragma once
+
+#include <cstddef>
+#include <new>
+#include <type_traits>
+#include <utility>
+#include <vector>
+
+namespace async::impl
+{
+
+/**
+ * @brief Coroutine-local values indexed by slot.
+ *
+ * Small trivially copyable values are stored inline, others are
+ * allocated on the heap.
+ */
+struct local_storage
+{
+    static constexpr std::size_t inline_size = 4 * sizeof(void*);
+
+    local_storage() = default;
+    local_storage(const local_storage&) = delete;
+    ~local_storage()
+    {
+        clear();
+    }
+
+    /**
+     * @brief Allocate index for a new slot.
+     */
+    static std::size_t next_index();
+
+    void* get(std::size_t index)
+    {
+        return index < _slots.size() ? _slots[index].value() : nullptr;
+    }
+
+    template <typename T, typename... Args>
+    T& emplace(std::size_t index, Args&&... args)
+    {
+        auto& s = prepare(index);
+
+        if constexpr (is_inline<T>)
+        {
+            auto p = new (s.data) T(std::forward<Args>(args)...);
+            s.used = true;
+            return *p;
+        }
+        else
+        {
+            auto p = new T(std::forward<Args>(args)...);
+            s.ptr = p;
+            s.destroy = [](void* v) { delete static_cast<T*>(v); };
+            return *p;
+        }
+    }
+
+    void reset(std::size_t index);
+    void clear();
+
+  private:
+    using destroy_func = void (*)(void*);
+
+    // inline values are relocated with memcpy when the slots grow
+    template <typename T>
+    static constexpr bool is_inline = sizeof(T) <= inline_size &&
+                                      alignof(T) <= alignof(std::max_align_t) &&
+                                      std::is_trivially_copyable_v<T>;
+
+    struct slot
+    {
+        void* value()
+        {
+            return ptr ? ptr : used ? data : nullptr;
+        }
+
+        // heap allocated value
+        void* ptr = nullptr;
+        destroy_func destroy = nullptr;
+        // inline value is set
+        bool used = false;
+        alignas(std::max_align_t) unsigned char data[inline_size];
+    };
+
+    slot& prepare(std::size_t index);
+
+  private:
+    std::vector<slot> _slots;
+};
+
+} // namespace async::impl
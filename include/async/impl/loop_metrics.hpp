@@ -0,0 +1,53 @@
+/* SPDX-License-Identifier: LGPL-2.1-or-later */
+
+#pragma once
+
+#include <async/impl/asio_fwd.hpp>
+#include <async/scheduler_metrics.hpp>
+
+#include <algorithm>
+#include <bit>
+
+namespace async::impl
+{
+
+/**
+ * @brief Collection of the scheduler metrics.
+ *
+ * The runnable count is always kept, the rest only when enabled.
+ */
+struct loop_metrics
+{
+    using clock = scheduler_metrics::clock;
+
+    static void posted()
+    {
+        s_metrics.runnable++;
+    }
+
+    static void dispatched()
+    {
+        s_metrics.runnable--;
+    }
+
+    static void lag(clock::duration d)
+    {
+        auto& m = s_metrics;
+        auto ns = std::chrono::duration_cast<std::chrono::nanoseconds>(d).count();
+        auto us = static_cast<std::uint64_t>(std::max<clock::rep>(ns + 999, 0) / 1000);
+        auto bucket = us > 1 ? std::bit_width(us - 1) : 0;
+
+        m.loop_lag[std::min<std::size_t>(bucket, scheduler_metrics::lag_buckets - 1)]++;
+        m.max_loop_lag = std::max(m.max_loop_lag, d);
+    }
+
+    /**
+     * @brief Run the loop timing every handler, while enabled.
+     */
+    static void run(io_context&);
+
+    static inline bool s_enabled = false;
+    static inline scheduler_metrics s_metrics;
+};
+
+} // namespace async::impl
@@ -0,0 +1,60 @@
+/* SPDX-License-Identifier: LGPL-2.1-or-later */
+
+#pragma once
+
+#include <async/error_code.hpp>
+#include <async/impl/this_coro.hpp>
+#include <boost/asio/error.hpp>
+#include <boost/asio/socket_base.hpp>
+
+#include <cerrno>
+
+namespace async::impl
+{
+
+using wait_type = boost::asio::socket_base::wait_type;
+
+/**
+ * @brief Error code for the last failed system call.
+ */
+inline error_code last_error()
+{
+    return error_code(errno, system_category());
+}
+
+/**
+ * @brief Check if native operation has to wait for descriptor readiness.
+ */
+inline bool would_block(const error_code& ec)
+{
+    return ec == boost::asio::error::would_block || ec == boost::asio::error::try_again;
+}
+
+/**
+ * @brief Run non-blocking native operation until it is complete.
+ *
+ * The operation is retried until it returns anything but would_block,
+ * current coroutine is suspended only when the descriptor is not ready.
+ */
+template <typename Object, typename Operation>
+error_code native_io(Object& object, wait_type wait, Operation&& op)
+{
+    while (true)
+    {
+        auto ec = op();
+
+        if (!would_block(ec))
+        {
+            return ec;
+        }
+
+        ec = object.async_wait(wait, async::this_coro);
+
+        if (ec)
+        {
+            return ec;
+        }
+    }
+}
+
+} // namespace async::impl
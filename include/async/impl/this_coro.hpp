@@ -3,9 +3,12 @@
 #pragma once
 
 #include <async/impl/asio_fwd.hpp>
+#include <async/impl/freelist.hpp>
 #include <async/impl/handler_base.hpp>
+#include <async/impl/trace.hpp>
 #include <async/this_coro.hpp>
 #include <boost/asio/async_result.hpp>
+#include <boost/asio/error.hpp>
 
 namespace boost::asio
 {
@@ -35,35 +38,70 @@ template <typename... CompletionArgs>
 struct wake_handler<async::impl::io_executor, CompletionArgs...> : async::impl::handler_base
 {
     using return_type = wake_return_type_t<CompletionArgs...>;
+    // operations are recycled by size, the asio cache holds only a couple
+    using allocator_type = async::impl::freelist_allocator<void>;
 
     constexpr wake_handler(return_type& r) : _r(r)
     {}
 
+    allocator_type get_allocator() const noexcept
+    {
+        return {};
+    }
+
     template <typename... Args>
         requires(sizeof...(Args) > 1)
     void operator()(Args&&... args)
     {
-        // NOTE: check if coro is canceled
-        //       when canceled, _r points to the deallocated memory
-        if (canceled())
+        // NOTE: check if coro is aborted
+        //       when aborted, _r points to the deallocated memory
+        if (aborted())
         {
             return;
         }
 
-        _r = std::forward_as_tuple<Args...>(args...);
-        resume();
+        _r = return_type(std::forward<Args>(args)...);
+        complete();
     }
 
     template <typename Arg>
     void operator()(Arg&& arg)
     {
+        if (aborted())
+        {
+            return;
+        }
+
         _r = std::forward<Arg>(arg);
+        complete();
+    }
+
+    // the wait queues resume through handler_base, only I/O is traced here
+    void complete()
+    {
+        async::impl::trace::record(coro(), async::impl::trace::event::io);
         resume();
     }
 
     return_type& _r;
 };
 
+/**
+ * @brief Set operation result to the cancellation error, if it has one.
+ */
+template <typename T>
+void set_aborted(T& r)
+{
+    if constexpr (std::is_same_v<T, boost::system::error_code>)
+    {
+        r = error::operation_aborted;
+    }
+    else if constexpr (requires { std::get<0>(r) = error::operation_aborted; })
+    {
+        std::get<0>(r) = error::operation_aborted;
+    }
+}
+
 template <typename... Signatures>
 struct async_result<async::this_coro_t, Signatures...>
 {
@@ -77,8 +115,19 @@ struct async_result<async::this_coro_t, Signatures...>
         return_type r;
         handler_type h{r};
         auto coro = h.get_coro();
+
+        if (coro->canceled() && coro->cancel_errors())
+        {
+            set_aborted(r);
+            return r;
+        }
+
         std::forward<Initiation>(init)(h, std::forward<InitArgs>(args)...);
-        h.suspend();
+
+        if (!h.suspend())
+        {
+            set_aborted(r);
+        }
         return r;
     }
 };
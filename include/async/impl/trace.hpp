@@ -0,0 +1,43 @@
+/* SPDX-License-Identifier: LGPL-2.1-or-later */
+
+#pragma once
+
+#include <async/impl/coro_impl.hpp>
+
+#include <cstdint>
+
+namespace async::impl
+{
+
+/**
+ * @brief Scheduling events recorded by the tracer.
+ *
+ * The check is inlined, the event is written only when tracing is enabled.
+ */
+struct trace
+{
+    enum class event : std::uint8_t
+    {
+        start,
+        resume,
+        suspend,
+        yield,
+        await,
+        finish,
+        io,
+    };
+
+    static void record(const coro_base& coro, event e)
+    {
+        if (s_enabled) [[unlikely]]
+        {
+            write(coro, e);
+        }
+    }
+
+    static void write(const coro_base&, event);
+
+    static inline bool s_enabled = false;
+};
+
+} // namespace async::impl
@@ -14,7 +14,10 @@ struct waiter : handler_base, list::list_hook
 
 struct head
 {
-    void wait();
+    /**
+     * @brief Suspend until woken, false if canceled in error mode.
+     */
+    bool wait();
     bool wake(bool wake_one = false);
 
   private:
@@ -0,0 +1,62 @@
+/* SPDX-License-Identifier: LGPL-2.1-or-later */
+
+#pragma once
+
+#include <async/scheduler.hpp>
+
+#include <atomic>
+#include <chrono>
+#include <cstdint>
+#include <functional>
+
+namespace async::impl
+{
+
+/**
+ * @brief Scheduler state sampled by the watchdog thread.
+ */
+struct watchdog
+{
+    using clock = std::chrono::steady_clock;
+    using callback = std::function<void(const watchdog_report&)>;
+
+    static void start(clock::duration threshold, callback&&, int signal);
+    static void stop();
+
+    /**
+     * @brief Beat period of the scheduler loop.
+     */
+    static clock::duration period();
+
+    /**
+     * @brief Stalls are reported only while the scheduler loop runs.
+     */
+    static void set_loop_running(bool);
+
+    /**
+     * @brief Record that the scheduler loop is alive.
+     */
+    static void beat()
+    {
+        s_alive_at.store(clock::now().time_since_epoch().count(), std::memory_order_relaxed);
+    }
+
+    /**
+     * @brief Record the switch to a coroutine, to report its run time.
+     */
+    static void resumed()
+    {
+        if (s_enabled) [[unlikely]]
+        {
+            s_resumed_at.store(clock::now().time_since_epoch().count(),
+                               std::memory_order_relaxed);
+        }
+    }
+
+    static inline bool s_enabled = false;
+    static inline std::atomic<std::int64_t> s_alive_at{0};
+    // read by the signal handler interrupting the scheduler thread
+    static inline std::atomic<std::int64_t> s_resumed_at{0};
+};
+
+} // namespace async::impl
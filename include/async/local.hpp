@@ -0,0 +1,123 @@
+/* SPDX-License-Identifier: LGPL-2.1-or-later */
+
+#pragma once
+
+#include <async/error_code.hpp>
+#include <async/impl/asio_fwd.hpp>
+#include <async/socket.hpp>
+#include <boost/asio/local/stream_protocol.hpp>
+
+#include <span>
+#include <vector>
+
+namespace async
+{
+
+namespace local
+{
+
+using proto = boost::asio::local::stream_protocol;
+using endpoint = boost::asio::local::stream_protocol::endpoint;
+using socket_base = tcp::socket_base;
+
+struct socket
+{
+    using socket_type = boost::asio::basic_stream_socket<proto, impl::io_executor>;
+
+    using const_buffer = boost::asio::const_buffer;
+    using mutable_buffer = boost::asio::mutable_buffer;
+    using executor_type = impl::io_executor;
+
+    /**
+     * @brief Maximum number of descriptors passed with a single message.
+     */
+    static constexpr std::size_t max_fds = 253;
+
+    socket();
+    socket(socket&&);
+    socket(const proto&);
+    socket(const proto&, const int&);
+    ~socket();
+
+    socket& operator=(socket&&);
+
+    socket_type& boost_socket()
+    {
+        return _socket;
+    }
+
+    socket& lowest_layer()
+    {
+        return *this;
+    }
+
+    const socket& lowest_layer() const
+    {
+        return *this;
+    }
+
+    error_code open(const proto& = proto());
+    error_code assign(const proto&, const int&);
+    error_code close();
+    error_code release(int&);
+    error_code cancel();
+    error_code bind(const endpoint&);
+    error_code async_wait(socket_base::wait_type);
+    error_code async_connect(const endpoint&);
+    error_code async_send(const_buffer, std::size_t&);
+    error_code async_receive(mutable_buffer, std::size_t&);
+
+    /**
+     * @brief Send data along with the descriptors (SCM_RIGHTS).
+     *
+     * The descriptors are attached to the first byte of data, so the buffer
+     * must not be empty. All data is sent before the coroutine is resumed.
+     */
+    error_code async_send_fds(const_buffer, std::span<const int>, std::size_t&);
+
+    /**
+     * @brief Receive data and descriptors passed by the peer.
+     *
+     * Received descriptors are appended to the vector and are owned by the
+     * caller, they are created with close-on-exec flag set.
+     */
+    error_code async_receive_fds(mutable_buffer, std::vector<int>&, std::size_t&);
+
+    /**
+     * @brief Create a pair of connected sockets.
+     */
+    static error_code connect_pair(socket&, socket&);
+
+  private:
+    socket_type _socket;
+};
+
+struct acceptor
+{
+    using executor_type = impl::io_executor;
+
+    acceptor();
+    acceptor(acceptor&&) = default;
+    acceptor(const proto&);
+    acceptor(const endpoint&);
+    acceptor(const proto&, const int&);
+
+    acceptor& operator=(acceptor&&) = default;
+
+    error_code open(const proto& = proto());
+    error_code close();
+    error_code assign(const proto&, const int&);
+    error_code release(int&);
+    error_code bind(const endpoint&);
+    error_code listen(int = socket_base::max_listen_connections);
+    error_code cancel();
+    error_code async_wait(socket_base::wait_type);
+    error_code async_accept(socket&);
+
+  private:
+    boost::asio::basic_socket_acceptor<proto, impl::io_executor> _acceptor;
+};
+
+} // namespace local
+
+} // namespace async
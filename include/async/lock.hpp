@@ -12,15 +12,18 @@ struct sema : private impl::signaled
     sema() : impl::signaled(true)
     {}
 
-    void lock()
+    /**
+     * @brief Acquire the semaphore, false if canceled in error mode.
+     */
+    [[nodiscard]] bool lock()
     {
         if (is_signaled())
         {
             clear();
-            return;
+            return true;
         }
 
-        signaled::wait();
+        return signaled::wait();
     }
 
     void unlock()
@@ -2,14 +2,115 @@
 
 #pragma once
 
+#include <async/coro_stats.hpp>
+#include <async/scheduler_metrics.hpp>
+#include <async/stack_usage.hpp>
+
+#include <chrono>
+#include <csignal>
+#include <cstddef>
+#include <functional>
+#include <string>
+#include <vector>
+
 namespace async
 {
 
+/**
+ * @brief Stall of the scheduler loop detected by the watchdog.
+ */
+struct watchdog_report
+{
+    // name of the running coroutine, empty if stuck outside of coroutines
+    std::string coro;
+    // time since the loop was last seen alive
+    std::chrono::nanoseconds stalled{};
+    // time since the running coroutine was resumed
+    std::chrono::nanoseconds running{};
+    // return addresses of the running code, for backtrace_symbols()
+    std::vector<void*> backtrace;
+};
+
 struct scheduler
 {
     static void setup_signal_handlers();
     static void run();
     static void stop(bool failure = false);
+
+    /**
+     * @brief Periodically release stack pages of idle coroutines.
+     *
+     * Pages below the stack pointer of coroutines not resumed for at least
+     * the idle threshold are returned to the system with MADV_DONTNEED, or
+     * MADV_FREE if lazy_free is set. Zero threshold disables reclamation.
+     * The pass timer keeps run() from returning until disabled.
+     */
+    static void set_stack_reclaim(std::chrono::milliseconds idle_threshold,
+                                  bool lazy_free = false);
+
+    /**
+     * @brief Total size of resident stack pages released so far.
+     */
+    static std::size_t reclaimed_stack_bytes();
+
+    /**
+     * @brief Reserve bytes at the top of new coroutine stacks for the arena.
+     *
+     * The coroutine arena starts in the reserved bytes and continues on
+     * the heap. Zero, the default, puts the whole arena on the heap.
+     */
+    static void set_stack_arena(std::size_t size);
+
+    /**
+     * @brief Measure the stack high-water marks of new coroutines.
+     *
+     * New stacks are filled with a canary pattern, which makes all their
+     * pages resident and disables their reclamation. The deepest
+     * overwritten byte is found when the coroutine finishes.
+     */
+    static void set_stack_watermark(bool enable);
+
+    /**
+     * @brief Stack high-water marks by coroutine name.
+     *
+     * Finished coroutines and the current depth of the live measured ones.
+     */
+    static std::vector<stack_usage> stack_watermarks();
+
+    /**
+     * @brief Runtime statistics of all existing coroutines.
+     *
+     * Empty statistics unless built with ASYNC_CORO_STATS.
+     */
+    static std::vector<coro_stats_entry> snapshot_stats();
+
+    /**
+     * @brief Collect the loop metrics.
+     *
+     * run() times every handler with poll_one()/run_one() while enabled,
+     * enabling takes effect on the next run(). Disabled by default.
+     */
+    static void enable_metrics(bool enable = true);
+
+    /**
+     * @brief Metrics of the scheduler loop, updated in place.
+     */
+    static const scheduler_metrics& metrics();
+
+    /**
+     * @brief Watch the scheduler loop from a separate thread.
+     *
+     * A heartbeat timer of the loop is sampled by the watchdog thread. When
+     * it does not fire for the threshold, the scheduler thread is
+     * interrupted by the signal to capture the backtrace and the running
+     * coroutine. The stall is logged to stderr once and passed to the
+     * callback, which is called on the watchdog thread. Must be called on
+     * the scheduler thread, zero threshold stops the watchdog. The
+     * heartbeat timer keeps run() from returning until stopped.
+     */
+    static void set_watchdog(std::chrono::milliseconds threshold,
+                             std::function<void(const watchdog_report&)> callback = {},
+                             int signal = SIGURG);
 };
 
 } // namespace async
@@ -0,0 +1,45 @@
+/* SPDX-License-Identifier: LGPL-2.1-or-later */
+
+#pragma once
+
+#include <array>
+#include <chrono>
+#include <cstddef>
+#include <cstdint>
+
+namespace async
+{
+
+/**
+ * @brief Health of the scheduler loop.
+ *
+ * Updated in place by the loop, reading it costs nothing.
+ */
+struct scheduler_metrics
+{
+    using clock = std::chrono::steady_clock;
+
+    static constexpr std::size_t lag_buckets = 20;
+
+    /**
+     * @brief Upper bound of the loop lag histogram bucket.
+     */
+    static constexpr clock::duration lag_limit(std::size_t bucket)
+    {
+        return std::chrono::microseconds(std::int64_t(1) << bucket);
+    }
+
+    // handlers run by the loop, and the rate over the last second
+    std::uint64_t handlers = 0;
+    double handlers_per_second = 0;
+    // coroutines resumed but not running yet
+    std::size_t runnable = 0;
+    // bucket i counts resumes switched to within lag_limit(i) from the post
+    std::array<std::uint64_t, lag_buckets> loop_lag{};
+    clock::duration max_loop_lag{};
+    // time spent running handlers, and waiting for events
+    clock::duration running{};
+    clock::duration blocked{};
+};
+
+} // namespace async
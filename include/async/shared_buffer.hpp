@@ -59,7 +59,7 @@ struct shared_buffer : impl::list::list_hook
      */
     std::size_t avail_write() const
     {
-        return static_cast<std::size_t>(_end - _data.get());
+        return static_cast<std::size_t>(_end - write_ptr());
     }
 
     /**
@@ -5,12 +5,23 @@
 #include <async/function_ref.hpp>
 #include <async/impl/asio_fwd.hpp>
 #include <async/pending_op.hpp>
+#include <async/shared_buffer.hpp>
 #include <boost/asio/ip/address.hpp>
 #include <boost/asio/ip/tcp.hpp>
 
+#include <memory>
+#include <string>
+#include <string_view>
+#include <vector>
+
 namespace async
 {
 
+namespace impl
+{
+struct zerocopy_state;
+} // namespace impl
+
 namespace ip
 {
 
@@ -30,6 +41,8 @@ struct socket_base
 {
     static constexpr auto max_listen_connections = boost::asio::socket_base::max_listen_connections;
     using wait_type = boost::asio::socket_base::wait_type;
+    using reuse_address = boost::asio::socket_base::reuse_address;
+    using reuse_port = boost::asio::detail::socket_option::boolean<SOL_SOCKET, SO_REUSEPORT>;
 };
 
 template <typename T>
@@ -95,12 +108,110 @@ struct socket
     }
     error_code async_receive(mutable_buffer, std::size_t&);
 
+    /**
+     * @brief Receive available data without suspending.
+     *
+     * Returns would_block error if there is no data in the socket buffer.
+     */
+    error_code try_receive(mutable_buffer, std::size_t&);
+
+    /**
+     * @brief Send as much as fits into the socket buffer without suspending.
+     *
+     * Returns would_block error if the socket buffer is full.
+     */
+    error_code try_send(const_buffer, std::size_t&);
+
+    /**
+     * @brief check if async_send/async_receive try the operation first.
+     */
+    bool speculative() const
+    {
+        return _speculative;
+    }
+
+    /**
+     * @brief set speculative flag.
+     *
+     * When set, async_send/async_receive complete without suspending the
+     * coroutine if the socket is ready.
+     */
+    void set_speculative(bool speculative = true)
+    {
+        _speculative = speculative;
+    }
+
+    /**
+     * @brief Read until the buffer is full.
+     *
+     * Partial reads are continued by the completion handler, the coroutine
+     * is resumed once the buffer is full or an error occurs.
+     */
+    error_code async_read_exact(mutable_buffer, std::size_t&);
+
+    /**
+     * @brief Read into the string until it contains the delimiter.
+     *
+     * On success the size is the length of data up to and including the
+     * delimiter, the string may contain more data read past it.
+     */
+    error_code async_read_until(std::string&, std::string_view, std::size_t&);
+
+    /**
+     * @brief Write the whole buffer, resuming the coroutine once.
+     */
+    error_code async_write_all(const_buffer, std::size_t&);
+
+    /**
+     * @brief Send file contents straight from the page cache (sendfile).
+     *
+     * Sends length bytes of the file starting at the offset, the coroutine
+     * is suspended only while the socket send buffer is full.
+     */
+    error_code async_send_file(int, std::uint64_t, std::size_t, std::size_t&);
+
+    /**
+     * @brief Buffers smaller than this are sent by copy.
+     */
+    static constexpr std::size_t zerocopy_threshold = 16 * 1024;
+
+    /**
+     * @brief Send the whole buffer without copying it into the kernel (MSG_ZEROCOPY).
+     *
+     * The socket keeps the buffer until the kernel reports the transmission
+     * is complete, then it is handed back by reap_zerocopy(). Small buffers,
+     * or all buffers if zerocopy is not supported, are sent by copy and are
+     * handed back on the next reap.
+     */
+    error_code async_send_zerocopy(shared_buffer&&, std::size_t&);
+
+    /**
+     * @brief Move buffers released by the kernel to the vector, in send order.
+     */
+    error_code reap_zerocopy(std::vector<shared_buffer>&);
+
+    /**
+     * @brief Wait for at least one buffer to be released and reap it.
+     */
+    error_code async_reap_zerocopy(std::vector<shared_buffer>&);
+
+    /**
+     * @brief Number of buffers not handed back yet.
+     */
+    std::size_t zerocopy_pending() const;
+
   protected:
     pending_op async_connect(const endpoint&, function_ref<bool(error_code)>);
     pending_op async_receive(mutable_buffer, function_ref<bool(error_code, std::size_t)>);
 
   private:
+    error_code send_copy(const_buffer, std::size_t&);
+
+  private:
+    // buffers pinned by the kernel are released after the socket is closed
+    std::unique_ptr<impl::zerocopy_state> _zerocopy;
     socket_type _socket;
+    bool _speculative = false;
 };
 
 struct acceptor
@@ -132,6 +243,22 @@ struct acceptor
     pending_op async_accept(function_ref<R(error_code, socket&, endpoint&)>);
     error_code async_accept(socket&, endpoint&);
 
+    /**
+     * @brief Accept all pending connections, but no more than the limit.
+     *
+     * Accepted sockets are appended to the vector, the coroutine is
+     * suspended only if there is no pending connection.
+     */
+    error_code async_accept_batch(std::vector<socket>&, std::size_t);
+
+    /**
+     * @brief Open listening acceptor sharing the endpoint (SO_REUSEPORT).
+     *
+     * Each process (scheduler) opens its own acceptor on the same endpoint,
+     * and the kernel balances new connections between them.
+     */
+    error_code listen_shared(const endpoint&, int = socket_base::max_listen_connections);
+
   private:
     boost::asio::basic_socket_acceptor<proto, impl::io_executor> _acceptor;
 };
@@ -0,0 +1,23 @@
+/* SPDX-License-Identifier: LGPL-2.1-or-later */
+
+#pragma once
+
+#include <async/error_code.hpp>
+
+#include <cstddef>
+
+namespace async
+{
+
+/**
+ * @brief Move data between descriptors without copying it to user space.
+ *
+ * One of the descriptors must be a pipe, both should be in non-blocking
+ * mode. Moves up to length bytes, returning as soon as some data is moved
+ * and the next step would block. The coroutine is suspended only when
+ * nothing can be moved: the source has no data or the destination is full.
+ * The end of the source is reported as eof only when nothing was moved.
+ */
+error_code splice(int from, int to, std::size_t length, std::size_t& transferred);
+
+} // namespace async
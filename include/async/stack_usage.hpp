@@ -0,0 +1,46 @@
+/* SPDX-License-Identifier: LGPL-2.1-or-later */
+
+#pragma once
+
+#include <algorithm>
+#include <array>
+#include <bit>
+#include <cstddef>
+#include <string>
+
+namespace async
+{
+
+/**
+ * @brief Stack high-water marks of the coroutines with the same name.
+ */
+struct stack_usage
+{
+    static constexpr std::size_t buckets = 16;
+
+    /**
+     * @brief Upper bound of the histogram bucket in bytes.
+     */
+    static constexpr std::size_t bucket_limit(std::size_t bucket)
+    {
+        return std::size_t(1024) << bucket;
+    }
+
+    void add(std::size_t used)
+    {
+        auto bucket = used > 1024 ? std::bit_width((used - 1) / 1024) : 0;
+
+        histogram[std::min<std::size_t>(bucket, buckets - 1)]++;
+        count++;
+        max = std::max(max, used);
+    }
+
+    std::string name;
+    // number of measured coroutines, and the deepest use in bytes
+    std::size_t count = 0;
+    std::size_t max = 0;
+    // bucket i counts coroutines using up to bucket_limit(i) bytes
+    std::array<std::size_t, buckets> histogram{};
+};
+
+} // namespace async
@@ -0,0 +1,48 @@
+/* SPDX-License-Identifier: LGPL-2.1-or-later */
+
+#pragma once
+
+#include <cstddef>
+#include <iosfwd>
+
+namespace async
+{
+
+/**
+ * @brief Ring buffer of coroutine scheduling events.
+ *
+ * Records start, resume, suspend, yield, await, finish and I/O completion
+ * of every coroutine. The oldest events are overwritten when the buffer
+ * is full, so tracing may stay enabled in production.
+ */
+struct tracer
+{
+    static constexpr std::size_t default_capacity = 64 * 1024;
+
+    /**
+     * @brief Start recording into a buffer of at least capacity events.
+     */
+    static void enable(std::size_t capacity = default_capacity);
+
+    /**
+     * @brief Stop recording, recorded events are kept.
+     */
+    static void disable();
+
+    static bool enabled();
+
+    /**
+     * @brief Drop recorded events.
+     */
+    static void clear();
+
+    /**
+     * @brief Write recorded events in the Chrome trace JSON format.
+     *
+     * Each coroutine gets its own track named by the coroutine name, the
+     * file can be opened by chrome://tracing or Perfetto.
+     */
+    static void dump(std::ostream&);
+};
+
+} // namespace async
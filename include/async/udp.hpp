@@ -0,0 +1,90 @@
+/* SPDX-License-Identifier: LGPL-2.1-or-later */
+
+#pragma once
+
+#include <async/error_code.hpp>
+#include <async/impl/asio_fwd.hpp>
+#include <async/shared_buffer.hpp>
+#include <async/socket.hpp>
+#include <boost/asio/ip/udp.hpp>
+
+#include <vector>
+
+namespace async
+{
+
+namespace udp
+{
+
+using proto = boost::asio::ip::udp;
+using endpoint = boost::asio::ip::udp::endpoint;
+using address_v4 = boost::asio::ip::address_v4;
+using socket_base = tcp::socket_base;
+
+struct socket
+{
+    using socket_type = boost::asio::basic_datagram_socket<proto, impl::io_executor>;
+
+    using const_buffer = boost::asio::const_buffer;
+    using mutable_buffer = boost::asio::mutable_buffer;
+    using executor_type = impl::io_executor;
+
+    /**
+     * @brief Maximum number of datagrams transferred by a single system call.
+     */
+    static constexpr std::size_t max_batch = 1024;
+
+    socket();
+    socket(socket&&);
+    socket(const proto&);
+    socket(const endpoint&);
+    socket(const proto&, const int&);
+    ~socket();
+
+    socket& operator=(socket&&);
+
+    socket_type& boost_socket()
+    {
+        return _socket;
+    }
+
+    error_code open(const proto&);
+    error_code close();
+    error_code bind(const endpoint&);
+    error_code connect(const endpoint&);
+    error_code async_wait(socket_base::wait_type);
+    error_code async_send(const_buffer, std::size_t&);
+    error_code async_send_to(const_buffer, const endpoint&, std::size_t&);
+    error_code async_receive(mutable_buffer, std::size_t&);
+    error_code async_receive_from(mutable_buffer, endpoint&, std::size_t&);
+
+    /**
+     * @brief Receive a batch of datagrams into the buffers' write space.
+     *
+     * Every received datagram is committed to the buffer of the same index,
+     * the coroutine is suspended only if there is no datagram to read.
+     */
+    error_code async_receive_batch(std::vector<shared_buffer>&, std::size_t&);
+    error_code async_receive_batch(std::vector<shared_buffer>&, std::vector<endpoint>&,
+                                   std::size_t&);
+
+    /**
+     * @brief Send readable data of the buffers, one datagram per buffer.
+     *
+     * The coroutine is suspended only when the socket send buffer is full.
+     */
+    error_code async_send_batch(const std::vector<shared_buffer>&, std::size_t&);
+    error_code async_send_batch(const std::vector<shared_buffer>&, const std::vector<endpoint>&,
+                                std::size_t&);
+
+  private:
+    error_code receive_batch(std::vector<shared_buffer>&, endpoint*, std::size_t&);
+    error_code send_batch(const std::vector<shared_buffer>&, const endpoint*, std::size_t&);
+
+  private:
+    socket_type _socket;
+};
+
+} // namespace udp
+
+} // namespace async
@@ -0,0 +1,58 @@
+/* SPDX-License-Identifier: LGPL-2.1-or-later */
+
+#pragma once
+
+#include <async/shared_buffer.hpp>
+#include <async/socket.hpp>
+
+#include <memory>
+
+namespace async::tcp
+{
+
+/**
+ * @brief Socket write queue shared by several coroutines.
+ *
+ * Producers only queue buffers, writes are chained from the completion of
+ * the previous write. Buffers queued while a write is in flight are
+ * coalesced into the next gathered write. Producers return at once unless
+ * the queue exceeds the byte limit.
+ */
+struct write_queue
+{
+    static constexpr std::size_t default_limit = 1024 * 1024;
+
+    /**
+     * @brief Maximum number of buffers gathered into one write.
+     */
+    static constexpr std::size_t max_gather = 64;
+
+    write_queue(socket&, std::size_t limit = default_limit);
+    write_queue(const write_queue&) = delete;
+
+    /**
+     * @brief Queue buffer for sending.
+     *
+     * Suspends the producer while queued data exceeds the limit. Returns
+     * the first send error, after which the queue drops all data.
+     */
+    error_code push(shared_buffer&&);
+
+    /**
+     * @brief Wait until all queued data is sent.
+     */
+    error_code flush();
+
+    /**
+     * @brief Number of bytes waiting to be sent.
+     */
+    std::size_t queued() const;
+
+  private:
+    struct state;
+
+    // outlives the queue while a write is in flight
+    std::shared_ptr<state> _state;
+};
+
+} // namespace async::tcp
@@ -0,0 +1,192 @@
+/* SPDX-License-Identifier: LGPL-2.1-or-later */
+
+#include <async/connection_pool.hpp>
+#include <async/impl/native_io.hpp>
+
+#include <sys/socket.h>
+
+#include <algorithm>
+
+namespace async::tcp
+{
+
+connection_pool::connection_pool() : connection_pool(options{})
+{}
+
+connection_pool::connection_pool(options o) :
+    _options(std::move(o)), _timer(impl::io::get_executor())
+{}
+
+connection_pool::~connection_pool()
+{
+    _timer.cancel();
+}
+
+error_code connection_pool::acquire(const endpoint& ep, socket& s)
+{
+    // keeps the entry from evict_idle() while the coroutine is suspended,
+    // and gives back the connection slot on any exit without a connection
+    struct pin
+    {
+        pin(entry& e) : e(e)
+        {
+            e.acquiring++;
+        }
+
+        ~pin()
+        {
+            e.acquiring--;
+
+            if (!acquired)
+            {
+                e.active -= reserved;
+                // pass on the wake this coroutine may have consumed
+                e.waiters.wake(true);
+            }
+        }
+
+        entry& e;
+        bool reserved = false;
+        bool acquired = false;
+    };
+
+    auto& e = _entries[ep];
+    pin p(e);
+
+    while (true)
+    {
+        // most recently used connection is the most likely alive
+        while (!e.idle.empty())
+        {
+            auto idle = std::move(e.idle.back());
+            e.idle.pop_back();
+
+            if (alive(idle.s))
+            {
+                s = std::move(idle.s);
+                e.active++;
+                p.acquired = true;
+                return {};
+            }
+        }
+
+        if (e.active < _options.max_active)
+        {
+            break;
+        }
+
+        if (!e.waiters.wait())
+        {
+            return boost::asio::error::operation_aborted;
+        }
+    }
+
+    // counted while connecting, the connect may be unwound
+    e.active++;
+    p.reserved = true;
+
+    socket fresh;
+    auto ec = fresh.async_connect(ep);
+
+    if (ec)
+    {
+        return ec;
+    }
+
+    s = std::move(fresh);
+    p.acquired = true;
+    return {};
+}
+
+void connection_pool::release(const endpoint& ep, socket&& s, bool reuse)
+{
+    auto it = _entries.find(ep);
+
+    // not acquired from this pool
+    if (it == _entries.end() || it->second.active == 0)
+    {
+        s.close();
+        return;
+    }
+
+    auto& e = it->second;
+
+    e.active--;
+
+    if (reuse && s.boost_socket().is_open())
+    {
+        e.idle.push_back({std::move(s), clock::now()});
+        arm_timer();
+    }
+    else
+    {
+        s.close();
+    }
+
+    e.waiters.wake(true);
+}
+
+void connection_pool::evict_idle()
+{
+    auto deadline = clock::now() - _options.idle_timeout;
+
+    for (auto& [ep, e] : _entries)
+    {
+        // released in order, the oldest connections are at the front
+        while (!e.idle.empty() && e.idle.front().since <= deadline)
+        {
+            e.idle.front().s.close();
+            e.idle.pop_front();
+        }
+    }
+
+    std::erase_if(_entries, [](const auto& item) {
+        const auto& e = item.second;
+        return e.idle.empty() && e.active == 0 && e.acquiring == 0;
+    });
+}
+
+std::size_t connection_pool::idle(const endpoint& ep) const
+{
+    auto it = _entries.find(ep);
+    return it != _entries.end() ? it->second.idle.size() : 0;
+}
+
+bool connection_pool::alive(socket& s)
+{
+    char c;
+
+    // closed by the peer, or unexpected data breaking the protocol
+    auto r = ::recv(s.boost_socket().native_handle(), &c, 1, MSG_PEEK | MSG_DONTWAIT);
+
+    return r < 0 && impl::would_block(impl::last_error());
+}
+
+void connection_pool::arm_timer()
+{
+    if (_timer_armed)
+    {
+        return;
+    }
+
+    _timer_armed = true;
+    _timer.expires_after(_options.idle_timeout);
+    _timer.async_wait([this](error_code ec) {
+        if (ec)
+        {
+            return;
+        }
+
+        _timer_armed = false;
+        evict_idle();
+
+        if (std::ranges::any_of(_entries, [](const auto& item) {
+                return !item.second.idle.empty();
+            }))
+        {
+            arm_timer();
+        }
+    });
+}
+
+} // namespace async::tcp
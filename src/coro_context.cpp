@@ -4,12 +4,137 @@
 #include <async/impl/asio_fwd.hpp>
 #include <async/impl/coro_context.hpp>
 #include <async/impl/coro_impl.hpp>
+#include <boost/context/fixedsize_stack.hpp>
+
+#include <sys/mman.h>
+#include <unistd.h>
+
+#include <cstring>
+#include <map>
+#include <vector>
 
 namespace async::impl
 {
 
 using fiber = boost::context::fiber;
 
+static constexpr unsigned char canary = 0xa5;
+
+/**
+ * @brief Lowest stack address overwritten since the canary fill.
+ */
+static const char* touched_bottom(const boost::context::stack_context& sctx)
+{
+    auto p = static_cast<const char*>(sctx.sp) - sctx.size;
+    auto top = static_cast<const char*>(sctx.sp);
+
+    while (p < top && static_cast<unsigned char>(*p) == canary)
+    {
+        p++;
+    }
+
+    return p;
+}
+
+static void fill_canary(const boost::context::stack_context& sctx, const char* from)
+{
+    auto top = static_cast<const char*>(sctx.sp);
+
+    std::memset(const_cast<char*>(from), canary, top - from);
+}
+
+// high-water marks of the finished coroutines by name
+static std::map<std::string, stack_usage, std::less<>> watermarks;
+
+/**
+ * @brief Fixed size stack allocator reporting the allocated stack.
+ *
+ * The arena bytes are reserved at the top of the allocation, the fiber
+ * gets the rest below them as its stack.
+ */
+struct recording_stack
+{
+    using traits = boost::context::stack_traits;
+
+    static constexpr std::size_t max_cached = 64;
+
+    recording_stack(std::size_t arena, bool paint, boost::context::stack_context* out) :
+        _alloc(traits::default_size() + arena), _alloc_size(traits::default_size() + arena),
+        _arena(arena), _paint(paint), _out(out)
+    {}
+
+    boost::context::stack_context allocate()
+    {
+        // most recently freed stack is the most likely resident
+        for (auto i = s_count; i > 0; i--)
+        {
+            auto& cached = s_cache[i - 1];
+
+            if (cached.arena == _arena && cached.sctx.size + _arena == _alloc_size)
+            {
+                auto sctx = cached.sctx;
+
+                if (_paint && !cached.painted)
+                {
+                    fill_canary(sctx, static_cast<char*>(sctx.sp) - sctx.size);
+                }
+
+                cached = s_cache[--s_count];
+                *_out = sctx;
+                return sctx;
+            }
+        }
+
+        auto sctx = _alloc.allocate();
+
+        // deallocate() gets the same bottom from the reduced context
+        sctx.sp = static_cast<char*>(sctx.sp) - _arena;
+        sctx.size -= _arena;
+
+        if (_paint)
+        {
+            fill_canary(sctx, static_cast<char*>(sctx.sp) - sctx.size);
+        }
+
+        *_out = sctx;
+        return sctx;
+    }
+
+    void deallocate(boost::context::stack_context& sctx) noexcept
+    {
+        if (s_count < max_cached)
+        {
+            // the fiber is gone, restore the canary below the touched bytes
+            if (_paint)
+            {
+                fill_canary(sctx, touched_bottom(sctx));
+            }
+
+            s_cache[s_count++] = {sctx, _arena, _paint};
+            return;
+        }
+
+        _alloc.deallocate(sctx);
+    }
+
+    struct cached_stack
+    {
+        boost::context::stack_context sctx;
+        std::size_t arena;
+        bool painted;
+    };
+
+    boost::context::fixedsize_stack _alloc;
+    std::size_t _alloc_size;
+    std::size_t _arena;
+    bool _paint;
+    boost::context::stack_context* _out;
+
+    // trivially destructible to stay usable during the static destruction
+    static inline cached_stack s_cache[max_cached];
+    static inline std::size_t s_count = 0;
+};
+
 struct coro_run_scope
 {
     using coro_context_ptr = coro_context*;
@@ -55,6 +180,8 @@ struct coro_run_scope
 
 void coro_context::resume()
 {
+    _resumes++;
+    _reclaimed = false;
     _parent_ctx = s_current;
     s_current = this;
 
@@ -63,6 +190,9 @@ void coro_context::resume()
 
 void coro_context::suspend()
 {
+    char sp;
+
+    _suspended_sp = &sp;
     s_current = _parent_ctx;
     _caller = fiber(std::move(_caller)).resume();
 }
@@ -70,10 +200,17 @@ void coro_context::suspend()
 coro_context& coro_context::create(coro_func&& func)
 {
     coro_context* context;
+    boost::context::stack_context stack;
+    auto arena = s_arena_size;
+    auto paint = s_watermark;
 
-    fiber callee(coro_run_scope(std::move(func), context));
+    fiber callee(std::allocator_arg, recording_stack(arena, paint, &stack),
+                 coro_run_scope(std::move(func), context));
 
     context->_coro = std::move(callee).resume();
+    context->_stack = stack;
+    context->_arena_size = arena;
+    context->_painted = paint;
 
     return *context;
 }
@@ -81,6 +218,19 @@ coro_context& coro_context::create(coro_func&& func)
 void coro_context::do_finish()
 {
     const auto& impl = get_impl();
+
+    if (_painted)
+    {
+        auto& name = impl->name();
+        auto it = watermarks.find(name);
+
+        if (it == watermarks.end())
+        {
+            it = watermarks.emplace(name, stack_usage{.name = name}).first;
+        }
+        it->second.add(stack_used());
+    }
+
     coro_base::finish(impl);
     s_current = _parent_ctx;
 }
@@ -97,6 +247,73 @@ void coro_context::destroy()
     std::move(coro).resume();
 }
 
+std::size_t coro_context::reclaim_stack(bool lazy_free)
+{
+    static const std::size_t page = ::sysconf(_SC_PAGESIZE);
+    static std::vector<unsigned char> resident;
+
+    // reclaim only coroutines not resumed since the previous pass, zeroed
+    // pages would break the high-water mark
+    if (_resumes != _seen_resumes || _reclaimed || !_suspended_sp || _painted)
+    {
+        _seen_resumes = _resumes;
+        return 0;
+    }
+
+    _reclaimed = true;
+
+    // keep a page below the recorded pointer for the context switch frames
+    auto bottom = reinterpret_cast<uintptr_t>(_stack.sp) - _stack.size;
+    auto begin = (bottom + page - 1) & ~(page - 1);
+    auto end = (reinterpret_cast<uintptr_t>(_suspended_sp) & ~(page - 1)) - page;
+
+    if (end <= begin)
+    {
+        return 0;
+    }
+
+    auto addr = reinterpret_cast<void*>(begin);
+    std::size_t length = end - begin;
+    std::size_t reclaimed = 0;
+
+    resident.resize(length / page);
+    if (::mincore(addr, length, resident.data()) == 0)
+    {
+        for (auto r : resident)
+        {
+            reclaimed += (r & 1) ? page : 0;
+        }
+    }
+
+    if (reclaimed > 0)
+    {
+        ::madvise(addr, length, lazy_free ? MADV_FREE : MADV_DONTNEED);
+    }
+
+    return reclaimed;
+}
+
+void coro_context::set_arena_size(std::size_t size)
+{
+    // keep the stack pointer aligned
+    s_arena_size = (size + 63) & ~std::size_t(63);
+}
+
+std::size_t coro_context::stack_used() const
+{
+    return static_cast<const char*>(_stack.sp) - touched_bottom(_stack);
+}
+
+void coro_context::set_watermark(bool enable)
+{
+    s_watermark = enable;
+}
+
+std::map<std::string, stack_usage, std::less<>> coro_context::finished_watermarks()
+{
+    return watermarks;
+}
+
 void coro_context::cancel()
 {
     if (this == s_current)
@@ -105,7 +322,12 @@ void coro_context::cancel()
     }
     else
     {
-        auto canceled = std::move(_coro);
+        // the unwinding coroutine restores its own parent as the current
+        auto current = s_current;
+        {
+            auto canceled = std::move(_coro);
+        }
+        s_current = current;
     }
 }
 
@@ -4,11 +4,41 @@
 #include <async/impl/asio_fwd.hpp>
 #include <async/impl/coro_context.hpp>
 #include <async/impl/coro_impl.hpp>
+#include <async/impl/freelist.hpp>
+#include <async/impl/loop_metrics.hpp>
+#include <async/impl/trace.hpp>
+#include <async/impl/watchdog.hpp>
 #include <boost/asio/post.hpp>
 
+#include <algorithm>
+
 namespace async::impl
 {
 
+/**
+ * @brief Handler allocating its operation from the freelist.
+ *
+ * The small per-thread cache of asio is exceeded when many coroutines
+ * are resumed at once, e.g. by an event.
+ */
+template <typename Function>
+struct recycled_handler
+{
+    using allocator_type = freelist_allocator<void>;
+
+    allocator_type get_allocator() const noexcept
+    {
+        return {};
+    }
+
+    void operator()()
+    {
+        func();
+    }
+
+    Function func;
+};
+
 struct coro_service : public boost::asio::detail::execution_context_service_base<coro_service>
 {
     coro_service(impl::io_context& io) :
@@ -21,6 +51,8 @@ struct coro_service : public boost::asio::detail::execution_context_service_base
         {
             auto& coro = _list.front();
             _list.pop_front();
+            // the error mode resumes through the loop, which runs no more
+            // handlers, only unwinding frees the stack and its objects now
             coro.set_cancel_throws(true);
             coro.cancel();
         }
@@ -29,7 +61,9 @@ struct coro_service : public boost::asio::detail::execution_context_service_base
     boost::intrusive::list<coro_base, boost::intrusive::constant_time_size<false>> _list;
 };
 
-coro_base::coro_base(std::string&& name) : _name(std::move(name))
+static std::uint64_t next_id = 0;
+
+coro_base::coro_base(std::string&& name) : _name(std::move(name)), _id(++next_id)
 {
     auto& service = boost::asio::use_service<coro_service>(impl::io::get_context());
     service._list.push_back(*this);
@@ -51,10 +85,43 @@ void coro_base::cancel()
 {
     _canceled = true;
 
+    if (_state == state::created)
+    {
+        // never started, nothing to unwind
+        _pending_func = nullptr;
+        _state = state::done;
+        return;
+    }
+
     if (_cancel_throws && _ctx)
     {
         _ctx->cancel();
     }
+    else if (_cancel_errors && _ctx && _state == state::waiting)
+    {
+        // suspension point returns the cancellation error
+        _cancel_resumed = true;
+        resume(_ctx->get_impl());
+    }
+}
+
+std::pmr::memory_resource* coro_base::arena()
+{
+    if (!_arena)
+    {
+        auto upstream = std::pmr::new_delete_resource();
+
+        if (_ctx && _ctx->arena_size() > 0)
+        {
+            _arena.emplace(_ctx->arena_buffer(), _ctx->arena_size(), upstream);
+        }
+        else
+        {
+            _arena.emplace(upstream);
+        }
+    }
+
+    return &*_arena;
 }
 
 std::shared_ptr<void> coro_base::get_data(const std::type_info& info)
@@ -84,18 +151,55 @@ coro_ptr coro_base::current_coro()
     return context->get_impl();
 }
 
+local_storage& coro_base::current_locals()
+{
+    auto context = coro_context::current();
+    if (!context)
+    {
+        throw exception::no_coroutine();
+    }
+
+    // avoid copying the shared pointer on the hot path
+    return context->get_impl_ptr()->_locals;
+}
+
 void coro_base::start(const coro_ptr& impl, std::move_only_function<void()>&& func)
 {
-    auto& ctx = impl::coro_context::create(std::move(func));
+    start_lazy(impl, std::move(func));
+    run(impl);
+}
+
+void coro_base::start_lazy(const coro_ptr& impl, std::move_only_function<void()>&& func)
+{
+    impl->_pending_func = std::move(func);
+    impl->set_state(state::created);
+}
+
+void coro_base::run(const coro_ptr& impl)
+{
+    if (impl->_state != state::created)
+    {
+        return;
+    }
+
+    auto& ctx = impl::coro_context::create(std::move(impl->_pending_func));
 
     ctx.attach(impl);
 
     impl->attach(&ctx);
+    impl->set_state(state::suspended);
+    trace::record(*impl, trace::event::start);
+#ifdef ASYNC_CORO_STATS
+    impl->_suspended_at = coro_stats::clock::now();
+#endif
     resume(impl);
 }
 
-void coro_base::await(coro_ptr impl)
+bool coro_base::await(coro_ptr impl)
 {
+    // lazily created coroutine is started by the first waiter
+    run(impl);
+
     auto curr = coro_context::current();
     auto ctx = impl->_ctx;
 
@@ -103,26 +207,46 @@ void coro_base::await(coro_ptr impl)
 
     if (impl->_state == state::done)
     {
-        return;
+        return true;
     }
 
     if (impl->_state != state::ready)
     {
         auto curr_impl = curr->get_impl();
 
-        curr_impl->set_state(state::suspended);
+        if (curr_impl->canceled() && curr_impl->cancel_errors())
+        {
+            return false;
+        }
+
+        curr_impl->set_state(state::waiting);
 
         impl->set_waiter(curr_impl);
+        trace::record(*curr_impl, trace::event::await);
 
-        resume(impl);
+        // coroutine waiting for an event is resumed by the event only
+        if (impl->_state == state::suspended)
+        {
+            resume(impl);
+        }
 
         curr->suspend();
+        curr_impl->_cancel_resumed = false;
+
+        if (impl->_state != state::done && impl->_state != state::ready)
+        {
+            // resumed by the cancellation
+            impl->set_waiter(nullptr);
+            return false;
+        }
     }
 
     if (impl->_state == state::ready && impl->_ctx)
     {
         impl->set_state(state::suspended);
     }
+
+    return true;
 }
 
 void coro_base::yield(coro_ptr impl)
@@ -133,6 +257,7 @@ void coro_base::yield(coro_ptr impl)
     check_coro(ctx && ctx == curr);
     impl->wake();
     impl->set_state(state::ready);
+    trace::record(*impl, trace::event::yield);
     curr->suspend();
 }
 
@@ -153,37 +278,136 @@ void coro_base::reschedule(coro_ptr impl)
     curr->suspend();
 }
 
-void coro_base::suspend(const coro_ptr& impl)
+bool coro_base::suspend(const coro_ptr& impl)
 {
     auto curr = coro_context::current();
     auto ctx = impl->_ctx;
 
     check_coro(ctx && ctx == curr);
 
-    impl->set_state(state::suspended);
+    if (impl->_canceled && impl->_cancel_errors)
+    {
+        return false;
+    }
+
+    // waiting for an event, only the event handler may resume it
+    impl->set_state(state::waiting);
     curr->suspend();
+
+    // woken by the event before the cancellation keeps the event result
+    auto cancel_resumed = impl->_cancel_resumed;
+    impl->_cancel_resumed = false;
+
+    return !cancel_resumed;
 }
 
 void coro_base::resume(const coro_ptr& impl)
 {
-    if (impl->_state == state::suspended)
+    if (impl->_state == state::suspended || impl->_state == state::waiting)
     {
         // avoid multiple resuming
         impl->set_state(state::pending);
-        boost::asio::post(impl::io::get_executor(), [=] {
+        loop_metrics::posted();
+        if (coro_stats::enabled || loop_metrics::s_enabled)
+        {
+            impl->_pending_at = coro_stats::clock::now();
+        }
+        boost::asio::post(impl::io::get_executor(), recycled_handler{[=] {
+            loop_metrics::dispatched();
+
             // check if coro still pends execution
             if (impl->_state == state::pending)
             {
                 impl->set_state(state::running);
+                trace::record(*impl, trace::event::resume);
+                watchdog::resumed();
+#ifdef ASYNC_CORO_STATS
+                auto& stats = impl->_stats;
+                auto start = coro_stats::clock::now();
+
+                if (loop_metrics::s_enabled)
+                {
+                    loop_metrics::lag(start - impl->_pending_at);
+                }
+                stats.resumes++;
+                // rescheduling coroutine is made runnable before it suspends
+                auto runnable_at = std::max(impl->_pending_at, impl->_suspended_at);
+
+                stats.scheduling_delay += start - runnable_at;
+                stats.suspended_time += runnable_at - impl->_suspended_at;
+                impl->_ctx->resume();
+                impl->_suspended_at = coro_stats::clock::now();
+                stats.cpu_time += impl->_suspended_at - start;
+#else
+                if (loop_metrics::s_enabled)
+                {
+                    loop_metrics::lag(coro_stats::clock::now() - impl->_pending_at);
+                }
                 impl->_ctx->resume();
+#endif
+                trace::record(*impl, trace::event::suspend);
             }
             if (impl->_state == state::done && impl->_ctx)
             {
                 impl->_ctx->destroy();
                 impl->attach(nullptr);
             }
-        });
+        }});
+    }
+}
+
+std::size_t coro_base::reclaim_stacks(bool lazy_free)
+{
+    auto& service = boost::asio::use_service<coro_service>(impl::io::get_context());
+    std::size_t reclaimed = 0;
+
+    for (auto& coro : service._list)
+    {
+        // running coroutine is on the stack right now
+        if (coro._ctx && coro._state != state::running && coro._state != state::done)
+        {
+            reclaimed += coro._ctx->reclaim_stack(lazy_free);
+        }
     }
+
+    return reclaimed;
+}
+
+std::vector<coro_stats_entry> coro_base::snapshot_stats()
+{
+    auto& service = boost::asio::use_service<coro_service>(impl::io::get_context());
+    std::vector<coro_stats_entry> entries;
+
+    for (auto& coro : service._list)
+    {
+        entries.push_back({coro._name, coro.running(), coro.stats()});
+    }
+
+    return entries;
+}
+
+std::vector<stack_usage> coro_base::stack_watermarks()
+{
+    auto& service = boost::asio::use_service<coro_service>(impl::io::get_context());
+    auto usage = coro_context::finished_watermarks();
+    std::vector<stack_usage> entries;
+
+    // include the current depth of the live coroutines
+    for (auto& coro : service._list)
+    {
+        if (coro._ctx && coro._ctx->painted())
+        {
+            auto it = usage.try_emplace(coro._name, stack_usage{.name = coro._name}).first;
+            it->second.add(coro._ctx->stack_used());
+        }
+    }
+
+    for (auto& [name, u] : usage)
+    {
+        entries.push_back(std::move(u));
+    }
+
+    return entries;
 }
 
 void coro_base::check_coro(bool check)
@@ -210,6 +434,10 @@ void coro_base::wake()
 
 void coro_base::finish(coro_ptr impl)
 {
+    // destroy local values while still in the coroutine context
+    impl->_locals.clear();
+    impl->_arena.reset();
+    trace::record(*impl, trace::event::finish);
     impl->wake();
     impl->set_state(state::done);
 }
@@ -0,0 +1,204 @@
+/* SPDX-License-Identifier: LGPL-2.1-or-later */
+
+#include <async/coro.hpp>
+#include <async/coro_pool.hpp>
+#include <async/error_code.hpp>
+#include <async/exceptions.hpp>
+#include <async/impl/asio_fwd.hpp>
+#include <async/impl/wait_queue.hpp>
+#include <boost/asio/steady_timer.hpp>
+#include <boost/context/fiber.hpp>
+
+#include <algorithm>
+#include <deque>
+
+namespace async
+{
+
+namespace impl
+{
+
+struct coro_pool_state : std::enable_shared_from_this<coro_pool_state>
+{
+    using clock = coro_pool::clock;
+    using timer_type = boost::asio::basic_waitable_timer<clock, boost::asio::wait_traits<clock>,
+                                                         impl::io_executor>;
+
+    coro_pool_state(std::string&& n, const coro_pool::options& o) :
+        name(std::move(n)), options(o), timer(impl::io::get_executor())
+    {}
+
+    void start_worker()
+    {
+        size++;
+        coro<>::start(name, [self = shared_from_this()](coro<>) { self->worker(); });
+    }
+
+    void worker()
+    {
+        while (!stopping)
+        {
+            if (jobs.empty())
+            {
+                if (shrink > 0)
+                {
+                    shrink--;
+                    break;
+                }
+
+                idle++;
+
+                // the waker stops counting the woken worker as idle
+                if (!waiters.wait())
+                {
+                    idle--;
+                    break;
+                }
+                continue;
+            }
+
+            auto job = std::move(jobs.front());
+            jobs.pop_front();
+
+            try
+            {
+                job->run();
+            }
+            catch (const boost::context::detail::forced_unwind&)
+            {
+                size--;
+                throw;
+            }
+            catch (...)
+            {
+                job->fail(std::current_exception());
+            }
+        }
+
+        size--;
+    }
+
+    // back to back posts see the woken workers as busy
+    bool wake_idle()
+    {
+        if (idle == 0 || !waiters.wake(true))
+        {
+            return false;
+        }
+
+        idle--;
+        idle_low = std::min(idle_low, idle);
+        return true;
+    }
+
+    void post(std::shared_ptr<pool_job>&& job)
+    {
+        jobs.push_back(std::move(job));
+
+        if (wake_idle())
+        {
+            return;
+        }
+
+        if (size < options.max_size)
+        {
+            start_worker();
+            arm_timer();
+        }
+    }
+
+    void arm_timer()
+    {
+        if (timer_armed || size <= options.min_size)
+        {
+            return;
+        }
+
+        timer_armed = true;
+        idle_low = idle;
+        timer.expires_after(options.idle_timeout);
+        timer.async_wait([self = shared_from_this()](error_code ec) {
+            self->timer_armed = false;
+
+            if (ec || self->stopping)
+            {
+                return;
+            }
+
+            // stop workers which were idle during the whole period
+            auto surplus = std::min(self->idle_low, self->size - self->options.min_size);
+
+            for (std::size_t i = 0; i < surplus && self->wake_idle(); i++)
+            {
+                self->shrink++;
+            }
+
+            self->arm_timer();
+        });
+    }
+
+    void stop()
+    {
+        stopping = true;
+        timer.cancel();
+        waiters.wake();
+        idle = 0;
+
+        for (auto& job : jobs)
+        {
+            job->fail(std::make_exception_ptr(exception::canceled()));
+        }
+        jobs.clear();
+    }
+
+    std::string name;
+    coro_pool::options options;
+    std::deque<std::shared_ptr<pool_job>> jobs;
+    wait_queue::head waiters;
+    std::size_t size = 0;
+    // workers waiting for a job and not woken yet
+    std::size_t idle = 0;
+    // lowest number of idle workers since the timer was armed
+    std::size_t idle_low = 0;
+    // number of idle workers requested to stop
+    std::size_t shrink = 0;
+    timer_type timer;
+    bool timer_armed = false;
+    bool stopping = false;
+};
+
+} // namespace impl
+
+coro_pool::coro_pool(std::string name) : coro_pool(std::move(name), options{})
+{}
+
+coro_pool::coro_pool(std::string name, options o) :
+    _state(std::make_shared<impl::coro_pool_state>(std::move(name), o))
+{
+    for (std::size_t i = 0; i < o.min_size; i++)
+    {
+        _state->start_worker();
+    }
+}
+
+coro_pool::~coro_pool()
+{
+    _state->stop();
+}
+
+void coro_pool::post(std::shared_ptr<impl::pool_job> job)
+{
+    _state->post(std::move(job));
+}
+
+std::size_t coro_pool::size() const
+{
+    return _state->size;
+}
+
+std::size_t coro_pool::idle() const
+{
+    return _state->idle;
+}
+
+} // namespace async
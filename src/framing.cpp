@@ -0,0 +1,272 @@
+/* SPDX-License-Identifier: LGPL-2.1-or-later */
+
+#include <async/framing.hpp>
+#include <boost/asio/error.hpp>
+
+#include <algorithm>
+#include <cstring>
+
+#if defined(__x86_64__)
+#include <immintrin.h>
+#endif
+
+namespace async
+{
+
+namespace impl
+{
+
+static const char* find_byte_scalar(const char* p, const char* end, char c)
+{
+    auto r = std::memchr(p, c, static_cast<std::size_t>(end - p));
+    return r ? static_cast<const char*>(r) : end;
+}
+
+#if defined(__x86_64__)
+
+__attribute__((target("avx2"))) static const char* find_byte_avx2(const char* p, const char* end,
+                                                                   char c)
+{
+    auto needle = _mm256_set1_epi8(c);
+
+    for (; end - p >= 32; p += 32)
+    {
+        auto data = _mm256_loadu_si256(reinterpret_cast<const __m256i*>(p));
+        auto mask = static_cast<unsigned>(_mm256_movemask_epi8(_mm256_cmpeq_epi8(data, needle)));
+        if (mask)
+        {
+            return p + __builtin_ctz(mask);
+        }
+    }
+
+    return find_byte_scalar(p, end, c);
+}
+
+// SSE2 is part of x86-64, no target attribute or CPU check needed
+static const char* find_byte_sse2(const char* p, const char* end, char c)
+{
+    auto needle = _mm_set1_epi8(c);
+
+    for (; end - p >= 16; p += 16)
+    {
+        auto data = _mm_loadu_si128(reinterpret_cast<const __m128i*>(p));
+        auto mask = static_cast<unsigned>(_mm_movemask_epi8(_mm_cmpeq_epi8(data, needle)));
+        if (mask)
+        {
+            return p + __builtin_ctz(mask);
+        }
+    }
+
+    return find_byte_scalar(p, end, c);
+}
+
+#endif
+
+using find_byte_func = const char* (*)(const char*, const char*, char);
+
+static find_byte_func select_find_byte()
+{
+#if defined(__x86_64__)
+    __builtin_cpu_init();
+
+    if (__builtin_cpu_supports("avx2"))
+    {
+        return find_byte_avx2;
+    }
+
+    return find_byte_sse2;
+#else
+    return find_byte_scalar;
+#endif
+}
+
+const char* find_byte(const char* begin, const char* end, char c)
+{
+    static const auto func = select_find_byte();
+
+    return func(begin, end, c);
+}
+
+} // namespace impl
+
+frame_decoder::frame_decoder(framing f, std::size_t chunk) : _framing(std::move(f)), _chunk(chunk)
+{}
+
+boost::asio::mutable_buffer frame_decoder::prepare()
+{
+    auto avail = _buffer ? _buffer->avail_read() : 0;
+    auto room = _buffer ? _buffer->avail_write() : 0;
+
+    if (_needed > avail + room)
+    {
+        // known frame size, make it fit
+        reserve(std::max(_needed, _chunk));
+    }
+    else if (room == 0)
+    {
+        // unknown frame size, grow geometrically
+        reserve(avail + std::max(avail, _chunk));
+    }
+
+    return {_buffer->write_ptr(), _buffer->avail_write()};
+}
+
+void frame_decoder::commit(std::size_t count)
+{
+    _buffer->commit(count);
+}
+
+void frame_decoder::reserve(std::size_t capacity)
+{
+    auto data = std::make_shared_for_overwrite<char[]>(capacity);
+    std::size_t size = 0;
+
+    // the only copy: incomplete frame does not fit the current buffer
+    if (_buffer)
+    {
+        size = _buffer->avail_read();
+        std::memcpy(data.get(), _buffer->read_ptr(), size);
+    }
+
+    _buffer.emplace(std::move(data), size, capacity);
+}
+
+error_code frame_decoder::next(std::optional<read_buffer>& frame)
+{
+    if (!_buffer)
+    {
+        return boost::asio::error::would_block;
+    }
+
+    std::size_t header = 0;
+    std::size_t payload = 0;
+    std::size_t trailer = 0;
+
+    if (_framing.type == framing::kind::delimiter)
+    {
+        if (_framing.delim.empty())
+        {
+            return boost::asio::error::invalid_argument;
+        }
+
+        if (!find_delimiter(payload))
+        {
+            return _scanned > _framing.max_frame ? boost::asio::error::message_size
+                                                 : boost::asio::error::would_block;
+        }
+
+        trailer = _framing.delim.size();
+    }
+    else
+    {
+        auto ec = parse_length(header, payload);
+        if (ec)
+        {
+            return ec;
+        }
+
+        if (payload > _framing.max_frame)
+        {
+            return boost::asio::error::message_size;
+        }
+
+        _needed = header + payload;
+
+        if (_buffer->avail_read() < _needed)
+        {
+            return boost::asio::error::would_block;
+        }
+    }
+
+    _buffer->consume(header);
+    frame.emplace(_buffer->split_read(payload));
+    _buffer->consume(trailer);
+
+    _needed = 0;
+    _scanned = 0;
+
+    return {};
+}
+
+error_code frame_decoder::parse_length(std::size_t& header, std::size_t& payload) const
+{
+    auto data = reinterpret_cast<const unsigned char*>(_buffer->read_ptr());
+    auto avail = _buffer->avail_read();
+
+    payload = 0;
+
+    if (_framing.type == framing::kind::varint)
+    {
+        constexpr std::size_t max_width = 10;
+
+        for (header = 0; header < std::min(avail, max_width); header++)
+        {
+            // only the lowest bit of the last byte fits, the length would wrap
+            if (header == max_width - 1 && data[header] > 1)
+            {
+                return boost::asio::error::invalid_argument;
+            }
+
+            payload |= static_cast<std::size_t>(data[header] & 0x7f) << (7 * header);
+
+            if (!(data[header] & 0x80))
+            {
+                header++;
+                return {};
+            }
+        }
+
+        return avail < max_width ? boost::asio::error::would_block
+                                 : boost::asio::error::invalid_argument;
+    }
+
+    header = _framing.width;
+
+    if (header != 1 && header != 2 && header != 4 && header != 8)
+    {
+        return boost::asio::error::invalid_argument;
+    }
+
+    if (avail < header)
+    {
+        return boost::asio::error::would_block;
+    }
+
+    for (std::size_t i = 0; i < header; i++)
+    {
+        auto shift = _framing.big_endian ? 8 * (header - i - 1) : 8 * i;
+        payload |= static_cast<std::size_t>(data[i]) << shift;
+    }
+
+    return {};
+}
+
+bool frame_decoder::find_delimiter(std::size_t& position)
+{
+    const auto& delim = _framing.delim;
+    auto begin = _buffer->read_ptr();
+    auto end = begin + _buffer->avail_read();
+    auto p = begin + _scanned;
+
+    while (true)
+    {
+        p = impl::find_byte(p, end, delim.front());
+
+        // delimiter might be incomplete, rescan from here
+        if (static_cast<std::size_t>(end - p) < delim.size())
+        {
+            _scanned = static_cast<std::size_t>(p - begin);
+            return false;
+        }
+
+        if (std::memcmp(p, delim.data(), delim.size()) == 0)
+        {
+            position = static_cast<std::size_t>(p - begin);
+            return true;
+        }
+
+        p++;
+    }
+}
+
+} // namespace async
@@ -0,0 +1,292 @@
+/* SPDX-License-Identifier: LGPL-2.1-or-later */
+
+#include <async/impl/native_io.hpp>
+#include <async/impl/this_coro.hpp>
+#include <async/local.hpp>
+#include <boost/asio/local/connect_pair.hpp>
+
+#include <sys/socket.h>
+
+#include <cstring>
+
+namespace async::local
+{
+
+socket::socket() : _socket(impl::io::get_executor())
+{}
+
+socket::socket(socket&&) = default;
+
+socket::socket(const proto& p) : _socket(impl::io::get_executor(), p)
+{}
+
+socket::socket(const proto& p, const int& h) : _socket(impl::io::get_executor(), p, h)
+{}
+
+socket::~socket()
+{}
+
+socket& socket::operator=(socket&&) = default;
+
+error_code socket::open(const proto& p)
+{
+    error_code ec;
+    _socket.open(p, ec);
+    return ec;
+}
+
+error_code socket::assign(const proto& p, const int& h)
+{
+    error_code ec;
+    _socket.assign(p, h, ec);
+    return ec;
+}
+
+error_code socket::close()
+{
+    error_code ec;
+    _socket.close(ec);
+    return ec;
+}
+
+error_code socket::release(int& h)
+{
+    error_code ec;
+    h = _socket.release(ec);
+    return ec;
+}
+
+error_code socket::cancel()
+{
+    error_code ec;
+    _socket.cancel(ec);
+    return ec;
+}
+
+error_code socket::bind(const endpoint& ep)
+{
+    error_code ec;
+    _socket.bind(ep, ec);
+    return ec;
+}
+
+error_code socket::async_wait(socket_base::wait_type w)
+{
+    return _socket.async_wait(w, this_coro);
+}
+
+error_code socket::async_connect(const endpoint& ep)
+{
+    return _socket.async_connect(ep, this_coro);
+}
+
+error_code socket::async_send(const_buffer buffer, std::size_t& sent)
+{
+    error_code ec;
+    std::tie(ec, sent) = _socket.async_send(buffer, this_coro);
+    return ec;
+}
+
+error_code socket::async_receive(mutable_buffer buffer, std::size_t& received)
+{
+    error_code ec;
+    std::tie(ec, received) = _socket.async_receive(buffer, this_coro);
+    return ec;
+}
+
+error_code socket::async_send_fds(const_buffer buffer, std::span<const int> fds, std::size_t& sent)
+{
+    sent = 0;
+
+    if (buffer.size() == 0 || fds.size() > max_fds)
+    {
+        return boost::asio::error::invalid_argument;
+    }
+
+    alignas(cmsghdr) char control[CMSG_SPACE(sizeof(int) * max_fds)];
+
+    iovec iov{const_cast<void*>(buffer.data()), buffer.size()};
+    msghdr msg{};
+
+    msg.msg_iov = &iov;
+    msg.msg_iovlen = 1;
+
+    if (!fds.empty())
+    {
+        auto length = sizeof(int) * fds.size();
+
+        msg.msg_control = control;
+        msg.msg_controllen = CMSG_SPACE(length);
+
+        auto cmsg = CMSG_FIRSTHDR(&msg);
+        cmsg->cmsg_level = SOL_SOCKET;
+        cmsg->cmsg_type = SCM_RIGHTS;
+        cmsg->cmsg_len = CMSG_LEN(length);
+        std::memcpy(CMSG_DATA(cmsg), fds.data(), length);
+    }
+
+    auto fd = _socket.native_handle();
+
+    auto ec = impl::native_io(_socket, socket_base::wait_type::wait_write, [&]() -> error_code {
+        auto r = ::sendmsg(fd, &msg, MSG_DONTWAIT | MSG_NOSIGNAL);
+        if (r < 0)
+        {
+            return impl::last_error();
+        }
+
+        sent = static_cast<std::size_t>(r);
+        return {};
+    });
+
+    // descriptors went along with the first chunk, send the rest as is
+    while (!ec && sent < buffer.size())
+    {
+        std::size_t n;
+        ec = async_send(buffer + sent, n);
+        sent += n;
+    }
+
+    return ec;
+}
+
+error_code socket::async_receive_fds(mutable_buffer buffer, std::vector<int>& fds,
+                                     std::size_t& received)
+{
+    received = 0;
+
+    alignas(cmsghdr) char control[CMSG_SPACE(sizeof(int) * max_fds)];
+
+    iovec iov{buffer.data(), buffer.size()};
+    msghdr msg{};
+
+    msg.msg_iov = &iov;
+    msg.msg_iovlen = 1;
+    msg.msg_control = control;
+    msg.msg_controllen = sizeof(control);
+
+    auto fd = _socket.native_handle();
+
+    auto ec = impl::native_io(_socket, socket_base::wait_type::wait_read, [&]() -> error_code {
+        auto r = ::recvmsg(fd, &msg, MSG_DONTWAIT | MSG_CMSG_CLOEXEC);
+        if (r < 0)
+        {
+            return impl::last_error();
+        }
+
+        received = static_cast<std::size_t>(r);
+        return {};
+    });
+
+    if (ec)
+    {
+        return ec;
+    }
+
+    for (auto cmsg = CMSG_FIRSTHDR(&msg); cmsg; cmsg = CMSG_NXTHDR(&msg, cmsg))
+    {
+        if (cmsg->cmsg_level == SOL_SOCKET && cmsg->cmsg_type == SCM_RIGHTS)
+        {
+            auto count = (cmsg->cmsg_len - CMSG_LEN(0)) / sizeof(int);
+            auto data = CMSG_DATA(cmsg);
+
+            for (std::size_t i = 0; i < count; i++)
+            {
+                int h;
+                std::memcpy(&h, data + i * sizeof(int), sizeof(int));
+                fds.push_back(h);
+            }
+        }
+    }
+
+    if (msg.msg_flags & MSG_CTRUNC)
+    {
+        return boost::asio::error::message_size;
+    }
+
+    if (received == 0 && buffer.size() != 0)
+    {
+        return boost::asio::error::eof;
+    }
+
+    return {};
+}
+
+error_code socket::connect_pair(socket& s1, socket& s2)
+{
+    error_code ec;
+    boost::asio::local::connect_pair(s1._socket, s2._socket, ec);
+    return ec;
+}
+
+acceptor::acceptor() : _acceptor(impl::io::get_executor())
+{}
+
+acceptor::acceptor(const proto& p) : _acceptor(impl::io::get_executor(), p)
+{}
+
+acceptor::acceptor(const endpoint& e) : _acceptor(impl::io::get_executor(), e, false)
+{}
+
+acceptor::acceptor(const proto& p, const int& h) : _acceptor(impl::io::get_executor(), p, h)
+{}
+
+error_code acceptor::open(const proto& p)
+{
+    error_code ec;
+    _acceptor.open(p, ec);
+    return ec;
+}
+
+error_code acceptor::close()
+{
+    error_code ec;
+    _acceptor.close(ec);
+    return ec;
+}
+
+error_code acceptor::assign(const proto& p, const int& h)
+{
+    error_code ec;
+    _acceptor.assign(p, h, ec);
+    return ec;
+}
+
+error_code acceptor::release(int& h)
+{
+    error_code ec;
+    h = _acceptor.release(ec);
+    return ec;
+}
+
+error_code acceptor::bind(const endpoint& ep)
+{
+    error_code ec;
+    _acceptor.bind(ep, ec);
+    return ec;
+}
+
+error_code acceptor::listen(int backlog)
+{
+    error_code ec;
+    _acceptor.listen(backlog, ec);
+    return ec;
+}
+
+error_code acceptor::cancel()
+{
+    error_code ec;
+    _acceptor.cancel(ec);
+    return ec;
+}
+
+error_code acceptor::async_wait(socket_base::wait_type w)
+{
+    return _acceptor.async_wait(w, this_coro);
+}
+
+error_code acceptor::async_accept(socket& s)
+{
+    return _acceptor.async_accept(s.boost_socket(), this_coro);
+}
+
+} // namespace async::local
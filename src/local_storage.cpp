@@ -0,0 +1,70 @@
+/* SPDX-License-Identifier: LGPL-2.1-or-later */
+
+#include <async/impl/local_storage.hpp>
+
+#include <algorithm>
+
+namespace async::impl
+{
+
+static std::size_t& slot_count()
+{
+    // slots are allocated during the static initialization
+    static std::size_t count = 0;
+    return count;
+}
+
+std::size_t local_storage::next_index()
+{
+    return slot_count()++;
+}
+
+void local_storage::reset(std::size_t index)
+{
+    if (index >= _slots.size())
+    {
+        return;
+    }
+
+    auto& s = _slots[index];
+    auto ptr = s.ptr;
+    auto destroy = s.destroy;
+
+    s.ptr = nullptr;
+    s.destroy = nullptr;
+    s.used = false;
+
+    // the destructor may set other slots and reallocate them
+    if (destroy)
+    {
+        destroy(ptr);
+    }
+}
+
+void local_storage::clear()
+{
+    // values may access other slots when destroyed
+    for (std::size_t i = 0; i < _slots.size(); i++)
+    {
+        reset(i);
+    }
+
+    _slots.clear();
+}
+
+local_storage::slot& local_storage::prepare(std::size_t index)
+{
+    if (index >= _slots.size())
+    {
+        // allocate all slots known so far at once
+        _slots.resize(std::max(index + 1, slot_count()));
+    }
+    else
+    {
+        reset(index);
+    }
+
+    return _slots[index];
+}
+
+} // namespace async::impl
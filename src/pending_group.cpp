@@ -35,7 +35,10 @@ bool pending_group::wait_all()
 
     _callback = &cb;
 
-    wq.wait();
+    if (!wq.wait())
+    {
+        res = false;
+    }
 
     _list.clear();
     _callback = nullptr;
@@ -13,13 +13,23 @@ bool pending_op::wait()
     _wq = &wq;
     _res = &res;
 
-    wq.wait();
+    if (!wq.wait())
+    {
+        // the operation may complete after this frame is gone
+        _wq = nullptr;
+        return false;
+    }
 
     return res;
 }
 
 void pending_op::invoke(bool r) const
 {
+    if (!_wq)
+    {
+        return;
+    }
+
     *_res = r;
     _wq->wake();
 }
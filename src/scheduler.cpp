@@ -1,8 +1,13 @@
 /* SPDX-License-Identifier: LGPL-2.1-or-later */
 
 #include <async/impl/asio_fwd.hpp>
+#include <async/impl/coro_context.hpp>
+#include <async/impl/coro_impl.hpp>
+#include <async/impl/loop_metrics.hpp>
+#include <async/impl/watchdog.hpp>
 #include <async/scheduler.hpp>
 #include <boost/asio/signal_set.hpp>
+#include <boost/asio/steady_timer.hpp>
 
 namespace async
 {
@@ -13,6 +18,102 @@ namespace impl
 static io_context async_io_context;
 static boost::asio::signal_set ss(async_io_context, SIGINT, SIGHUP);
 
+struct stack_reclaim
+{
+    void arm()
+    {
+        timer.expires_after(threshold);
+        timer.async_wait([this](boost::system::error_code ec) {
+            if (ec)
+            {
+                return;
+            }
+
+            // idle for a whole period when not resumed since the previous pass
+            reclaimed += coro_base::reclaim_stacks(lazy_free);
+            arm();
+        });
+    }
+
+    boost::asio::steady_timer timer{async_io_context};
+    std::chrono::milliseconds threshold{};
+    bool lazy_free = false;
+    std::size_t reclaimed = 0;
+};
+
+static stack_reclaim reclaim;
+
+void loop_metrics::run(io_context& io)
+{
+    auto& m = s_metrics;
+    auto last = clock::now();
+    auto window = last;
+    auto window_handlers = m.handlers;
+
+    while (s_enabled)
+    {
+        if (io.poll_one())
+        {
+            auto now = clock::now();
+
+            m.handlers++;
+            m.running += now - last;
+            last = now;
+        }
+        else if (io.stopped())
+        {
+            return;
+        }
+        else
+        {
+            // the handler completing the wait is counted as blocked, here it
+            // mostly posts the resume of a coroutine
+            auto n = io.run_one();
+            auto now = clock::now();
+
+            m.handlers += n;
+            m.blocked += now - last;
+            last = now;
+
+            if (n == 0)
+            {
+                return;
+            }
+        }
+
+        if (last - window >= std::chrono::seconds(1))
+        {
+            m.handlers_per_second = (m.handlers - window_handlers) /
+                                    std::chrono::duration<double>(last - window).count();
+            window = last;
+            window_handlers = m.handlers;
+        }
+    }
+
+    io.run();
+}
+
+struct watchdog_beat
+{
+    void arm()
+    {
+        timer.expires_after(watchdog::period());
+        timer.async_wait([this](boost::system::error_code ec) {
+            if (ec)
+            {
+                return;
+            }
+
+            watchdog::beat();
+            arm();
+        });
+    }
+
+    boost::asio::steady_timer timer{async_io_context};
+};
+
+static watchdog_beat beat;
+
 io_context& io::get_context() noexcept
 {
     return async_io_context;
@@ -32,7 +133,18 @@ void scheduler::setup_signal_handlers()
 
 void scheduler::run()
 {
-    impl::io::get_context().run();
+    impl::watchdog::set_loop_running(true);
+
+    if (impl::loop_metrics::s_enabled)
+    {
+        impl::loop_metrics::run(impl::io::get_context());
+    }
+    else
+    {
+        impl::io::get_context().run();
+    }
+
+    impl::watchdog::set_loop_running(false);
 }
 
 void scheduler::stop(bool)
@@ -40,4 +152,64 @@ void scheduler::stop(bool)
     impl::io::get_context().stop();
 }
 
+void scheduler::set_stack_reclaim(std::chrono::milliseconds idle_threshold, bool lazy_free)
+{
+    impl::reclaim.timer.cancel();
+    impl::reclaim.threshold = idle_threshold;
+    impl::reclaim.lazy_free = lazy_free;
+
+    if (idle_threshold.count() > 0)
+    {
+        impl::reclaim.arm();
+    }
+}
+
+std::size_t scheduler::reclaimed_stack_bytes()
+{
+    return impl::reclaim.reclaimed;
+}
+
+void scheduler::set_stack_arena(std::size_t size)
+{
+    impl::coro_context::set_arena_size(size);
+}
+
+void scheduler::set_stack_watermark(bool enable)
+{
+    impl::coro_context::set_watermark(enable);
+}
+
+std::vector<stack_usage> scheduler::stack_watermarks()
+{
+    return impl::coro_base::stack_watermarks();
+}
+
+void scheduler::enable_metrics(bool enable)
+{
+    impl::loop_metrics::s_enabled = enable;
+}
+
+const scheduler_metrics& scheduler::metrics()
+{
+    return impl::loop_metrics::s_metrics;
+}
+
+std::vector<coro_stats_entry> scheduler::snapshot_stats()
+{
+    return impl::coro_base::snapshot_stats();
+}
+
+void scheduler::set_watchdog(std::chrono::milliseconds threshold,
+                             std::function<void(const watchdog_report&)> callback, int signal)
+{
+    impl::beat.timer.cancel();
+    impl::watchdog::stop();
+
+    if (threshold.count() > 0)
+    {
+        impl::watchdog::start(threshold, std::move(callback), signal);
+        impl::beat.arm();
+    }
+}
+
 } // namespace async
@@ -1,17 +1,82 @@
 /* SPDX-License-Identifier: LGPL-2.1-or-later */
 
+#include <async/impl/native_io.hpp>
 #include <async/impl/pending_op.hpp>
 #include <async/impl/this_coro.hpp>
 #include <async/socket.hpp>
+#include <boost/asio/read.hpp>
+#include <boost/asio/read_until.hpp>
+#include <boost/asio/write.hpp>
+
+#include <linux/errqueue.h>
+#include <netinet/in.h>
+#include <sys/sendfile.h>
+#include <sys/socket.h>
+
+#include <algorithm>
+#include <cstring>
+#include <deque>
 
 template class boost::wrapexcept<boost::asio::invalid_service_owner>;
 
+namespace async::impl
+{
+
+struct zerocopy_state
+{
+    struct op
+    {
+        // range of zerocopy send ids used to transmit the buffer
+        uint32_t first;
+        uint32_t count;
+        // number of ids reported as completed
+        uint32_t done;
+        shared_buffer buffer;
+    };
+
+    /**
+     * @brief Count the ids of the inclusive range reported by the kernel.
+     *
+     * The ids are 32-bit and wrap, the ranges are compared as offsets from
+     * the first id of every op.
+     */
+    void complete(uint32_t lo, uint32_t hi)
+    {
+        constexpr uint64_t wrap = uint64_t(1) << 32;
+        // the reported range never covers all the ids
+        uint64_t length = uint32_t(hi - lo) + uint64_t(1);
+
+        for (auto& op : ops)
+        {
+            uint64_t start = uint32_t(lo - op.first);
+            uint64_t end = start + length;
+
+            if (start < op.count)
+            {
+                op.done += static_cast<uint32_t>(std::min<uint64_t>(end, op.count) - start);
+            }
+            if (end > wrap)
+            {
+                op.done += static_cast<uint32_t>(std::min<uint64_t>(end - wrap, op.count));
+            }
+        }
+    }
+
+    std::deque<op> ops;
+    uint32_t next_id = 0;
+    bool supported = true;
+};
+
+} // namespace async::impl
+
 namespace async::tcp
 {
 
 socket::socket() : _socket(impl::io::get_executor())
 {}
 
+socket::socket(socket&&) = default;
+
 socket::socket(const proto& p) : _socket(impl::io::get_executor(), p)
 {}
 
@@ -24,13 +89,312 @@ socket::socket(const proto& p, const int& h) : _socket(impl::io::get_executor(),
 socket::~socket()
 {}
 
+socket& socket::operator=(socket&& other)
+{
+    // close the socket before releasing its zerocopy buffers
+    _socket = std::move(other._socket);
+    _zerocopy = std::move(other._zerocopy);
+    _speculative = other._speculative;
+    return *this;
+}
+
+socket& socket::operator=(socket_type&& s)
+{
+    _socket = std::move(s);
+    _zerocopy.reset();
+    return *this;
+}
+
 error_code socket::close()
 {
     error_code ec;
     _socket.close(ec);
+    // a reopened socket restarts the notification ids
+    _zerocopy.reset();
+    return ec;
+}
+
+error_code socket::async_wait(socket_base::wait_type w)
+{
+    return _socket.async_wait(w, this_coro);
+}
+
+error_code socket::async_send(const_buffer buffer, std::size_t& sent)
+{
+    error_code ec;
+
+    if (_speculative)
+    {
+        ec = try_send(buffer, sent);
+        if (!impl::would_block(ec))
+        {
+            return ec;
+        }
+    }
+
+    std::tie(ec, sent) = _socket.async_send(buffer, this_coro);
+    return ec;
+}
+
+error_code socket::async_receive(mutable_buffer buffer, std::size_t& received)
+{
+    error_code ec;
+
+    if (_speculative)
+    {
+        ec = try_receive(buffer, received);
+        if (!impl::would_block(ec))
+        {
+            return ec;
+        }
+    }
+
+    std::tie(ec, received) = _socket.async_receive(buffer, this_coro);
+    return ec;
+}
+
+error_code socket::try_receive(mutable_buffer buffer, std::size_t& received)
+{
+    received = 0;
+
+    auto r = ::recv(_socket.native_handle(), buffer.data(), buffer.size(), MSG_DONTWAIT);
+    if (r < 0)
+    {
+        return impl::last_error();
+    }
+
+    if (r == 0 && buffer.size() != 0)
+    {
+        return boost::asio::error::eof;
+    }
+
+    received = static_cast<std::size_t>(r);
+    return {};
+}
+
+error_code socket::try_send(const_buffer buffer, std::size_t& sent)
+{
+    sent = 0;
+
+    auto r = ::send(_socket.native_handle(), buffer.data(), buffer.size(),
+                    MSG_DONTWAIT | MSG_NOSIGNAL);
+    if (r < 0)
+    {
+        return impl::last_error();
+    }
+
+    sent = static_cast<std::size_t>(r);
+    return {};
+}
+
+error_code socket::async_read_exact(mutable_buffer buffer, std::size_t& received)
+{
+    error_code ec;
+    std::tie(ec, received) = boost::asio::async_read(_socket, buffer, this_coro);
+    return ec;
+}
+
+error_code socket::async_read_until(std::string& data, std::string_view delimiter,
+                                    std::size_t& received)
+{
+    error_code ec;
+    auto buffer = boost::asio::dynamic_buffer(data);
+    std::tie(ec, received) = boost::asio::async_read_until(_socket, buffer, delimiter, this_coro);
+    return ec;
+}
+
+error_code socket::async_write_all(const_buffer buffer, std::size_t& sent)
+{
+    error_code ec;
+    std::tie(ec, sent) = boost::asio::async_write(_socket, buffer, this_coro);
+    return ec;
+}
+
+error_code socket::send_copy(const_buffer buffer, std::size_t& sent)
+{
+    auto fd = _socket.native_handle();
+
+    return impl::native_io(_socket, socket_base::wait_type::wait_write, [&]() -> error_code {
+        while (sent < buffer.size())
+        {
+            auto r = ::send(fd, static_cast<const char*>(buffer.data()) + sent,
+                            buffer.size() - sent, MSG_DONTWAIT | MSG_NOSIGNAL);
+            if (r < 0)
+            {
+                return impl::last_error();
+            }
+
+            sent += static_cast<std::size_t>(r);
+        }
+
+        return {};
+    });
+}
+
+error_code socket::async_send_file(int fd, std::uint64_t offset, std::size_t length,
+                                   std::size_t& sent)
+{
+    error_code ec;
+
+    sent = 0;
+
+    // sendfile has no flags, the socket itself must not block
+    _socket.native_non_blocking(true, ec);
+    if (ec)
+    {
+        return ec;
+    }
+
+    auto out = _socket.native_handle();
+
+    return impl::native_io(_socket, socket_base::wait_type::wait_write, [&]() -> error_code {
+        while (sent < length)
+        {
+            auto pos = static_cast<off_t>(offset + sent);
+            auto r = ::sendfile(out, fd, &pos, length - sent);
+            if (r < 0)
+            {
+                return impl::last_error();
+            }
+
+            // the file is shorter than requested
+            if (r == 0)
+            {
+                return boost::asio::error::eof;
+            }
+
+            sent += static_cast<std::size_t>(r);
+        }
+
+        return {};
+    });
+}
+
+error_code socket::async_send_zerocopy(shared_buffer&& buffer, std::size_t& sent)
+{
+    auto fd = _socket.native_handle();
+
+    if (!_zerocopy)
+    {
+        int one = 1;
+        _zerocopy = std::make_unique<impl::zerocopy_state>();
+        _zerocopy->supported = ::setsockopt(fd, SOL_SOCKET, SO_ZEROCOPY, &one, sizeof(one)) == 0;
+    }
+
+    auto& zc = *_zerocopy;
+    auto data = buffer.read_ptr();
+    auto size = buffer.avail_read();
+    auto first = zc.next_id;
+    error_code ec;
+
+    sent = 0;
+
+    if (zc.supported && size >= zerocopy_threshold)
+    {
+        ec = impl::native_io(_socket, socket_base::wait_type::wait_write, [&]() -> error_code {
+            while (sent < size)
+            {
+                auto r = ::send(fd, data + sent, size - sent,
+                                MSG_ZEROCOPY | MSG_DONTWAIT | MSG_NOSIGNAL);
+                if (r < 0)
+                {
+                    return impl::last_error();
+                }
+
+                zc.next_id++;
+                sent += static_cast<std::size_t>(r);
+            }
+
+            return {};
+        });
+    }
+
+    // out of socket option memory, send the rest by copy
+    if (sent < size && (!ec || ec == boost::asio::error::no_buffer_space))
+    {
+        ec = send_copy({data, size}, sent);
+    }
+
+    // the kernel may still reference the pages of partially sent buffer
+    zc.ops.push_back({first, zc.next_id - first, 0, std::move(buffer)});
+
     return ec;
 }
 
+error_code socket::reap_zerocopy(std::vector<shared_buffer>& buffers)
+{
+    if (!_zerocopy)
+    {
+        return {};
+    }
+
+    auto& zc = *_zerocopy;
+    auto fd = _socket.native_handle();
+    error_code ec;
+
+    while (zc.supported)
+    {
+        constexpr auto length = sizeof(sock_extended_err) + sizeof(sockaddr_in6);
+        alignas(cmsghdr) char control[CMSG_SPACE(length)];
+        msghdr msg{};
+
+        msg.msg_control = control;
+        msg.msg_controllen = sizeof(control);
+
+        if (::recvmsg(fd, &msg, MSG_ERRQUEUE | MSG_DONTWAIT) < 0)
+        {
+            ec = impl::last_error();
+            break;
+        }
+
+        for (auto cmsg = CMSG_FIRSTHDR(&msg); cmsg; cmsg = CMSG_NXTHDR(&msg, cmsg))
+        {
+            if (!(cmsg->cmsg_level == SOL_IP && cmsg->cmsg_type == IP_RECVERR) &&
+                !(cmsg->cmsg_level == SOL_IPV6 && cmsg->cmsg_type == IPV6_RECVERR))
+            {
+                continue;
+            }
+
+            sock_extended_err err;
+            std::memcpy(&err, CMSG_DATA(cmsg), sizeof(err));
+
+            if (err.ee_errno == 0 && err.ee_origin == SO_EE_ORIGIN_ZEROCOPY)
+            {
+                zc.complete(err.ee_info, err.ee_data);
+            }
+        }
+    }
+
+    while (!zc.ops.empty() && zc.ops.front().done == zc.ops.front().count)
+    {
+        buffers.push_back(std::move(zc.ops.front().buffer));
+        zc.ops.pop_front();
+    }
+
+    return impl::would_block(ec) ? error_code{} : ec;
+}
+
+error_code socket::async_reap_zerocopy(std::vector<shared_buffer>& buffers)
+{
+    auto size = buffers.size();
+
+    return impl::native_io(_socket, socket_base::wait_type::wait_error, [&]() -> error_code {
+        auto ec = reap_zerocopy(buffers);
+
+        if (!ec && buffers.size() == size && zerocopy_pending())
+        {
+            return boost::asio::error::would_block;
+        }
+
+        return ec;
+    });
+}
+
+std::size_t socket::zerocopy_pending() const
+{
+    return _zerocopy ? _zerocopy->ops.size() : 0;
+}
+
 error_code socket::async_connect(const endpoint& e)
 {
     return _socket.async_connect(e, this_coro);
@@ -80,9 +444,90 @@ error_code acceptor::listen(int backlog)
     return ec;
 }
 
+error_code acceptor::async_accept(socket& s)
+{
+    return _acceptor.async_accept(s.boost_socket(), this_coro);
+}
+
 error_code acceptor::async_accept(socket& s, endpoint& e)
 {
     return _acceptor.async_accept(s.boost_socket(), e, this_coro);
 }
 
+error_code acceptor::async_accept_batch(std::vector<socket>& sockets, std::size_t max)
+{
+    error_code ec;
+    auto p = _acceptor.local_endpoint(ec).protocol();
+
+    // accept4 must not block when the queue is drained
+    if (!ec)
+    {
+        _acceptor.native_non_blocking(true, ec);
+    }
+
+    if (ec)
+    {
+        return ec;
+    }
+
+    auto fd = _acceptor.native_handle();
+
+    return impl::native_io(_acceptor, socket_base::wait_type::wait_read, [&]() -> error_code {
+        std::size_t count = 0;
+
+        while (count < max)
+        {
+            auto h = ::accept4(fd, nullptr, nullptr, SOCK_NONBLOCK | SOCK_CLOEXEC);
+            if (h < 0)
+            {
+                auto err = impl::last_error();
+
+                // connection has been reset while waiting in the queue
+                if (err == boost::asio::error::connection_aborted)
+                {
+                    continue;
+                }
+
+                // report accepted connections, the error would repeat next time
+                return count ? error_code{} : err;
+            }
+
+            sockets.emplace_back(p, h);
+            count++;
+        }
+
+        return {};
+    });
+}
+
+error_code acceptor::listen_shared(const endpoint& ep, int backlog)
+{
+    error_code ec;
+
+    _acceptor.open(ep.protocol(), ec);
+    if (!ec)
+    {
+        _acceptor.set_option(socket_base::reuse_address(true), ec);
+    }
+    if (!ec)
+    {
+        _acceptor.set_option(socket_base::reuse_port(true), ec);
+    }
+    if (!ec)
+    {
+        _acceptor.bind(ep, ec);
+    }
+    if (!ec)
+    {
+        _acceptor.listen(backlog, ec);
+    }
+    if (ec)
+    {
+        error_code ignored;
+        _acceptor.close(ignored);
+    }
+
+    return ec;
+}
+
 } // namespace async::tcp
\ No newline at end of file
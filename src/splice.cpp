@@ -0,0 +1,81 @@
+/* SPDX-License-Identifier: LGPL-2.1-or-later */
+
+#include <async/impl/native_io.hpp>
+#include <async/impl/this_coro.hpp>
+#include <async/splice.hpp>
+#include <boost/asio/posix/stream_descriptor.hpp>
+
+#include <fcntl.h>
+#include <poll.h>
+#include <unistd.h>
+
+namespace async
+{
+
+using descriptor = boost::asio::posix::basic_stream_descriptor<impl::io_executor>;
+
+static error_code wait_descriptor(int fd, descriptor::wait_type wait)
+{
+    // wait on a duplicate, the descriptor may be registered by its owner already
+    error_code ec;
+    descriptor d(impl::io::get_executor());
+
+    d.assign(::dup(fd), ec);
+    if (ec)
+    {
+        return ec;
+    }
+
+    return d.async_wait(wait, this_coro);
+}
+
+error_code splice(int from, int to, std::size_t length, std::size_t& transferred)
+{
+    constexpr auto flags = SPLICE_F_NONBLOCK | SPLICE_F_MOVE | SPLICE_F_MORE;
+
+    transferred = 0;
+
+    while (transferred < length)
+    {
+        auto r = ::splice(from, nullptr, to, nullptr, length - transferred, flags);
+        if (r > 0)
+        {
+            transferred += static_cast<std::size_t>(r);
+            continue;
+        }
+
+        // end of the source, report it once the moved data is consumed
+        if (r == 0)
+        {
+            return transferred ? error_code{} : boost::asio::error::eof;
+        }
+
+        auto ec = impl::last_error();
+        if (!impl::would_block(ec) || transferred)
+        {
+            return transferred ? error_code{} : ec;
+        }
+
+        // find out which side is not ready
+        pollfd fds[] = {{from, POLLIN, 0}, {to, POLLOUT, 0}};
+        ::poll(fds, 2, 0);
+
+        if (!(fds[0].revents & (POLLIN | POLLHUP | POLLERR)))
+        {
+            ec = wait_descriptor(from, descriptor::wait_read);
+        }
+        else
+        {
+            ec = wait_descriptor(to, descriptor::wait_write);
+        }
+
+        if (ec)
+        {
+            return ec;
+        }
+    }
+
+    return {};
+}
+
+} // namespace async
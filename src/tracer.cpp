@@ -0,0 +1,192 @@
+/* SPDX-License-Identifier: LGPL-2.1-or-later */
+
+#include <async/impl/trace.hpp>
+#include <async/tracer.hpp>
+
+#include <algorithm>
+#include <bit>
+#include <chrono>
+#include <cstring>
+#include <ostream>
+#include <string>
+#include <unordered_set>
+#include <vector>
+
+namespace async
+{
+
+namespace impl
+{
+
+/**
+ * @brief Recorded event, the name is copied to survive the coroutine.
+ */
+struct trace_record
+{
+    std::int64_t time;
+    std::uint64_t id;
+    trace::event type;
+    char name[23];
+};
+
+/**
+ * @brief Ring of the recorded events.
+ *
+ * Written only by the scheduler thread, the index needs no atomics.
+ */
+struct trace_ring
+{
+    std::vector<trace_record> records;
+    // total number of written records, the capacity is a power of two
+    std::size_t written = 0;
+};
+
+static trace_ring ring;
+
+void trace::write(const coro_base& coro, event e)
+{
+    auto& r = ring.records[ring.written++ & (ring.records.size() - 1)];
+    auto& name = coro.name();
+    auto size = std::min(name.size(), sizeof(r.name) - 1);
+
+    r.time = std::chrono::duration_cast<std::chrono::nanoseconds>(
+                 std::chrono::steady_clock::now().time_since_epoch())
+                 .count();
+    r.id = coro.id();
+    r.type = e;
+    std::memcpy(r.name, name.data(), size);
+    r.name[size] = '\0';
+}
+
+static void write_string(std::ostream& os, const char* s)
+{
+    os << '"';
+    for (; *s; s++)
+    {
+        if (*s == '"' || *s == '\\')
+        {
+            os << '\\' << *s;
+        }
+        else if (static_cast<unsigned char>(*s) < 0x20)
+        {
+            os << ' ';
+        }
+        else
+        {
+            os << *s;
+        }
+    }
+    os << '"';
+}
+
+static const char* event_name(trace::event e)
+{
+    switch (e)
+    {
+        case trace::event::start:
+            return "start";
+        case trace::event::resume:
+            return "run";
+        case trace::event::suspend:
+            return "suspend";
+        case trace::event::yield:
+            return "yield";
+        case trace::event::await:
+            return "await";
+        case trace::event::finish:
+            return "finish";
+        case trace::event::io:
+            return "io";
+    }
+    return "";
+}
+
+} // namespace impl
+
+void tracer::enable(std::size_t capacity)
+{
+    capacity = std::bit_ceil(std::max<std::size_t>(capacity, 2));
+
+    if (impl::ring.records.size() != capacity)
+    {
+        impl::ring.records.resize(capacity);
+        impl::ring.written = 0;
+    }
+
+    impl::trace::s_enabled = true;
+}
+
+void tracer::disable()
+{
+    impl::trace::s_enabled = false;
+}
+
+bool tracer::enabled()
+{
+    return impl::trace::s_enabled;
+}
+
+void tracer::clear()
+{
+    impl::ring.written = 0;
+}
+
+void tracer::dump(std::ostream& os)
+{
+    using impl::trace;
+
+    auto& ring = impl::ring;
+    auto size = std::min(ring.written, ring.records.size());
+    auto mask = ring.records.size() - 1;
+    std::unordered_set<std::uint64_t> named;
+    std::unordered_set<std::uint64_t> running;
+    const char* sep = "\n";
+
+    os << "{\"displayTimeUnit\":\"ns\",\"traceEvents\":[";
+
+    for (auto i = ring.written - size; i < ring.written; i++)
+    {
+        const auto& r = ring.records[i & mask];
+
+        if (named.insert(r.id).second)
+        {
+            os << sep << "{\"ph\":\"M\",\"name\":\"thread_name\",\"pid\":1,\"tid\":" << r.id
+               << ",\"args\":{\"name\":";
+            impl::write_string(os, r.name);
+            os << "}}";
+            sep = ",\n";
+        }
+
+        const char* phase = "i";
+
+        if (r.type == trace::event::resume)
+        {
+            phase = "B";
+            running.insert(r.id);
+        }
+        else if (r.type == trace::event::suspend)
+        {
+            // the beginning of the slice has been overwritten
+            if (!running.erase(r.id))
+            {
+                continue;
+            }
+            phase = "E";
+        }
+
+        os << sep << "{\"ph\":\"" << phase << "\",\"name\":\"" << impl::event_name(r.type)
+           << "\",\"pid\":1,\"tid\":" << r.id << ",\"ts\":" << r.time / 1000 << '.'
+           << std::to_string(1000 + r.time % 1000).substr(1);
+
+        if (*phase == 'i')
+        {
+            os << ",\"s\":\"t\"";
+        }
+        os << '}';
+        sep = ",\n";
+    }
+
+    os << "\n]}\n";
+}
+
+} // namespace async
@@ -0,0 +1,254 @@
+/* SPDX-License-Identifier: LGPL-2.1-or-later */
+
+#include <async/impl/native_io.hpp>
+#include <async/impl/this_coro.hpp>
+#include <async/udp.hpp>
+#include <boost/container/small_vector.hpp>
+
+#include <sys/socket.h>
+#include <sys/uio.h>
+
+#include <algorithm>
+
+namespace async::udp
+{
+
+/**
+ * @brief Message headers of a single batch call.
+ *
+ * Owned by the call, a concurrent batch on the same socket can't redirect
+ * them while the coroutine waits for readiness.
+ */
+struct batch_headers
+{
+    // small batches are built on the coroutine stack
+    static constexpr std::size_t inline_size = 16;
+
+    explicit batch_headers(std::size_t size) : msgs(size), iovs(size)
+    {}
+
+    boost::container::small_vector<mmsghdr, inline_size> msgs;
+    boost::container::small_vector<iovec, inline_size> iovs;
+};
+
+socket::socket() : _socket(impl::io::get_executor())
+{}
+
+socket::socket(socket&&) = default;
+
+socket::socket(const proto& p) : _socket(impl::io::get_executor(), p)
+{}
+
+socket::socket(const endpoint& e) : _socket(impl::io::get_executor(), e)
+{}
+
+socket::socket(const proto& p, const int& h) : _socket(impl::io::get_executor(), p, h)
+{}
+
+socket::~socket()
+{}
+
+socket& socket::operator=(socket&&) = default;
+
+error_code socket::open(const proto& p)
+{
+    error_code ec;
+    _socket.open(p, ec);
+    return ec;
+}
+
+error_code socket::close()
+{
+    error_code ec;
+    _socket.close(ec);
+    return ec;
+}
+
+error_code socket::bind(const endpoint& ep)
+{
+    error_code ec;
+    _socket.bind(ep, ec);
+    return ec;
+}
+
+error_code socket::connect(const endpoint& ep)
+{
+    error_code ec;
+    _socket.connect(ep, ec);
+    return ec;
+}
+
+error_code socket::async_wait(socket_base::wait_type w)
+{
+    return _socket.async_wait(w, this_coro);
+}
+
+error_code socket::async_send(const_buffer buffer, std::size_t& sent)
+{
+    error_code ec;
+    std::tie(ec, sent) = _socket.async_send(buffer, this_coro);
+    return ec;
+}
+
+error_code socket::async_send_to(const_buffer buffer, const endpoint& ep, std::size_t& sent)
+{
+    error_code ec;
+    std::tie(ec, sent) = _socket.async_send_to(buffer, ep, this_coro);
+    return ec;
+}
+
+error_code socket::async_receive(mutable_buffer buffer, std::size_t& received)
+{
+    error_code ec;
+    std::tie(ec, received) = _socket.async_receive(buffer, this_coro);
+    return ec;
+}
+
+error_code socket::async_receive_from(mutable_buffer buffer, endpoint& ep, std::size_t& received)
+{
+    error_code ec;
+    std::tie(ec, received) = _socket.async_receive_from(buffer, ep, this_coro);
+    return ec;
+}
+
+error_code socket::async_receive_batch(std::vector<shared_buffer>& buffers, std::size_t& count)
+{
+    return receive_batch(buffers, nullptr, count);
+}
+
+error_code socket::async_receive_batch(std::vector<shared_buffer>& buffers,
+                                       std::vector<endpoint>& peers, std::size_t& count)
+{
+    peers.resize(buffers.size());
+    return receive_batch(buffers, peers.data(), count);
+}
+
+error_code socket::async_send_batch(const std::vector<shared_buffer>& buffers, std::size_t& count)
+{
+    return send_batch(buffers, nullptr, count);
+}
+
+error_code socket::async_send_batch(const std::vector<shared_buffer>& buffers,
+                                    const std::vector<endpoint>& peers, std::size_t& count)
+{
+    if (peers.size() < buffers.size())
+    {
+        count = 0;
+        return boost::asio::error::invalid_argument;
+    }
+
+    return send_batch(buffers, peers.data(), count);
+}
+
+error_code socket::receive_batch(std::vector<shared_buffer>& buffers, endpoint* peers,
+                                 std::size_t& count)
+{
+    auto size = std::min(buffers.size(), max_batch);
+
+    count = 0;
+
+    if (size == 0)
+    {
+        return {};
+    }
+
+    batch_headers h(size);
+
+    for (std::size_t i = 0; i < size; i++)
+    {
+        auto& buffer = buffers[i];
+        auto& msg = h.msgs[i].msg_hdr;
+
+        h.iovs[i] = {buffer.write_ptr(), buffer.avail_write()};
+
+        msg = {};
+        msg.msg_iov = &h.iovs[i];
+        msg.msg_iovlen = 1;
+
+        if (peers)
+        {
+            msg.msg_name = peers[i].data();
+            msg.msg_namelen = static_cast<socklen_t>(peers[i].capacity());
+        }
+    }
+
+    auto fd = _socket.native_handle();
+
+    return impl::native_io(_socket, socket_base::wait_type::wait_read, [&]() -> error_code {
+        auto r = ::recvmmsg(fd, h.msgs.data(), static_cast<unsigned>(size), MSG_DONTWAIT, nullptr);
+        if (r < 0)
+        {
+            return impl::last_error();
+        }
+
+        count = static_cast<std::size_t>(r);
+
+        for (std::size_t i = 0; i < count; i++)
+        {
+            buffers[i].commit(h.msgs[i].msg_len);
+
+            if (peers)
+            {
+                peers[i].resize(h.msgs[i].msg_hdr.msg_namelen);
+            }
+        }
+
+        return {};
+    });
+}
+
+error_code socket::send_batch(const std::vector<shared_buffer>& buffers, const endpoint* peers,
+                              std::size_t& count)
+{
+    count = 0;
+
+    auto fd = _socket.native_handle();
+
+    while (count < buffers.size())
+    {
+        auto size = std::min(buffers.size() - count, max_batch);
+
+        batch_headers h(size);
+
+        for (std::size_t i = 0; i < size; i++)
+        {
+            const auto& buffer = buffers[count + i];
+            auto& msg = h.msgs[i].msg_hdr;
+
+            h.iovs[i] = {const_cast<char*>(buffer.read_ptr()), buffer.avail_read()};
+
+            msg = {};
+            msg.msg_iov = &h.iovs[i];
+            msg.msg_iovlen = 1;
+
+            if (peers)
+            {
+                msg.msg_name = const_cast<boost::asio::detail::socket_addr_type*>(
+                    peers[count + i].data());
+                msg.msg_namelen = static_cast<socklen_t>(peers[count + i].size());
+            }
+        }
+
+        auto send = [&]() -> error_code {
+            auto r = ::sendmmsg(fd, h.msgs.data(), static_cast<unsigned>(size), MSG_DONTWAIT);
+            if (r < 0)
+            {
+                return impl::last_error();
+            }
+
+            count += static_cast<std::size_t>(r);
+            return {};
+        };
+
+        auto ec = impl::native_io(_socket, socket_base::wait_type::wait_write, send);
+
+        if (ec)
+        {
+            return ec;
+        }
+    }
+
+    return {};
+}
+
+} // namespace async::udp
@@ -5,32 +5,42 @@
 namespace async::impl::wait_queue
 {
 
-void head::wait()
+bool head::wait()
 {
     waiter w;
 
     _waiters.push_back(w);
 
-    w.suspend();
+    // canceled waiter is unlinked by the destructor
+    return w.suspend();
 }
 
 bool head::wake(bool wake_one)
 {
-    if (_waiters.empty())
-    {
-        return false;
-    }
+    bool woken = false;
 
-    do
+    while (!_waiters.empty())
     {
         auto& w = _waiters.front();
 
         _waiters.pop_front();
 
+        // resumed by the cancellation, it would not take the hand-off
+        if (w.cancel_resumed())
+        {
+            continue;
+        }
+
         w.resume();
-    } while (!_waiters.empty() && !wake_one);
+        woken = true;
+
+        if (wake_one)
+        {
+            break;
+        }
+    }
 
-    return true;
+    return woken;
 }
 
 } // namespace async::impl::wait_queue
\ No newline at end of file
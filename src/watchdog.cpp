@@ -0,0 +1,223 @@
+/* SPDX-License-Identifier: LGPL-2.1-or-later */
+
+#include <async/impl/coro_context.hpp>
+#include <async/impl/watchdog.hpp>
+
+#include <execinfo.h>
+#include <pthread.h>
+#include <signal.h>
+#include <unistd.h>
+
+#include <algorithm>
+#include <condition_variable>
+#include <cstdio>
+#include <cstring>
+#include <mutex>
+#include <thread>
+
+namespace async::impl
+{
+
+/**
+ * @brief Running code captured by the signal handler on the scheduler thread.
+ *
+ * The handler publishes the requested sequence number after writing the
+ * capture. A capture not published in time is never read, a late handler
+ * completes before the next request is handled.
+ */
+struct stall_capture
+{
+    static constexpr std::size_t max_frames = 64;
+
+    void* frames[max_frames];
+    int depth = 0;
+    char name[128];
+    std::int64_t running = 0;
+    std::atomic<std::uint64_t> requested = 0;
+    std::atomic<std::uint64_t> published = 0;
+};
+
+struct watchdog_thread
+{
+    using clock = watchdog::clock;
+
+    ~watchdog_thread()
+    {
+        stop();
+    }
+
+    void start()
+    {
+        stopping = false;
+        watchdog::beat();
+        thread = std::thread([this] { watch(); });
+    }
+
+    void stop()
+    {
+        if (!thread.joinable())
+        {
+            return;
+        }
+
+        {
+            std::lock_guard lock(mutex);
+            stopping = true;
+        }
+        cv.notify_one();
+        thread.join();
+    }
+
+    void watch()
+    {
+        std::int64_t reported = 0;
+        std::unique_lock lock(mutex);
+
+        while (!cv.wait_for(lock, period, [this] { return stopping; }))
+        {
+            if (!loop_running.load(std::memory_order_relaxed))
+            {
+                watchdog::beat();
+                continue;
+            }
+
+            auto alive = watchdog::s_alive_at.load(std::memory_order_relaxed);
+            auto stalled = clock::duration(clock::now().time_since_epoch().count() - alive);
+
+            // report every stall once
+            if (alive != reported && stalled >= threshold)
+            {
+                reported = alive;
+                report(stalled);
+            }
+        }
+    }
+
+    void report(clock::duration stalled)
+    {
+        using std::chrono::duration_cast;
+        using std::chrono::milliseconds;
+
+        watchdog_report r;
+
+        r.stalled = stalled;
+
+        auto seq = capture.requested.fetch_add(1, std::memory_order_relaxed) + 1;
+        auto published = [seq] {
+            return capture.published.load(std::memory_order_acquire) == seq;
+        };
+
+        ::pthread_kill(loop_thread, signal);
+
+        // the handler runs as soon as the scheduler thread gets the CPU,
+        // without the capture there is no backtrace
+        for (int i = 0; i < 100 && !published(); i++)
+        {
+            std::this_thread::sleep_for(milliseconds(1));
+        }
+
+        if (published())
+        {
+            r.coro = capture.name;
+            r.running = clock::duration(capture.running);
+            r.backtrace.assign(capture.frames, capture.frames + capture.depth);
+        }
+
+        std::fprintf(stderr, "async: scheduler loop blocked for %lld ms",
+                     static_cast<long long>(duration_cast<milliseconds>(stalled).count()));
+        if (!r.coro.empty())
+        {
+            std::fprintf(stderr, " by coroutine '%s' running for %lld ms", r.coro.data(),
+                         static_cast<long long>(duration_cast<milliseconds>(r.running).count()));
+        }
+        std::fprintf(stderr, "\n");
+        std::fflush(stderr);
+        ::backtrace_symbols_fd(r.backtrace.data(), r.backtrace.size(), STDERR_FILENO);
+
+        if (on_stall)
+        {
+            on_stall(r);
+        }
+    }
+
+    static void on_signal(int)
+    {
+        auto& c = capture;
+        auto seq = c.requested.load(std::memory_order_relaxed);
+        auto ctx = coro_context::current();
+
+        c.depth = ::backtrace(c.frames, stall_capture::max_frames);
+        c.name[0] = '\0';
+        c.running = 0;
+
+        if (ctx)
+        {
+            auto& name = ctx->get_impl_ptr()->name();
+            auto size = std::min(name.size(), sizeof(c.name) - 1);
+
+            std::memcpy(c.name, name.data(), size);
+            c.name[size] = '\0';
+            c.running = clock::now().time_since_epoch().count() -
+                        watchdog::s_resumed_at.load(std::memory_order_relaxed);
+        }
+
+        c.published.store(seq, std::memory_order_release);
+    }
+
+    clock::duration threshold{};
+    clock::duration period{};
+    watchdog::callback on_stall;
+    int signal = 0;
+    pthread_t loop_thread{};
+    std::thread thread;
+    std::mutex mutex;
+    std::condition_variable cv;
+    bool stopping = false;
+    std::atomic<bool> loop_running = false;
+
+    static inline stall_capture capture;
+};
+
+static watchdog_thread dog;
+
+void watchdog::start(clock::duration threshold, callback&& on_stall, int signal)
+{
+    stop();
+
+    // load the unwinder now, not in the signal handler
+    void* frame;
+    ::backtrace(&frame, 1);
+
+    struct sigaction sa = {};
+    sa.sa_handler = watchdog_thread::on_signal;
+    sa.sa_flags = SA_RESTART;
+    ::sigemptyset(&sa.sa_mask);
+    ::sigaction(signal, &sa, nullptr);
+
+    dog.threshold = threshold;
+    // sample at a quarter of the threshold to detect the stall in time
+    dog.period = std::max<clock::duration>(threshold / 4, std::chrono::milliseconds(1));
+    dog.on_stall = std::move(on_stall);
+    dog.signal = signal;
+    dog.loop_thread = ::pthread_self();
+    s_enabled = true;
+    dog.start();
+}
+
+void watchdog::stop()
+{
+    dog.stop();
+    s_enabled = false;
+}
+
+watchdog::clock::duration watchdog::period()
+{
+    return dog.period;
+}
+
+void watchdog::set_loop_running(bool running)
+{
+    dog.loop_running.store(running, std::memory_order_relaxed);
+}
+
+} // namespace async::impl
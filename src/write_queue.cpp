@@ -0,0 +1,147 @@
+/* SPDX-License-Identifier: LGPL-2.1-or-later */
+
+#include <async/impl/wait_queue.hpp>
+#include <async/write_queue.hpp>
+#include <boost/asio/write.hpp>
+
+#include <algorithm>
+#include <deque>
+#include <vector>
+
+namespace async::tcp
+{
+
+struct write_queue::state : std::enable_shared_from_this<state>
+{
+    state(socket& s, std::size_t l) : sock(s), limit(l)
+    {}
+
+    /**
+     * @brief Write the buffers at the front of the queue.
+     *
+     * The buffers stay queued until the write completes, the completion
+     * holds the state alive.
+     */
+    void send()
+    {
+        auto count = std::min(queue.size(), max_gather);
+        std::size_t size = 0;
+
+        gather.clear();
+
+        for (std::size_t i = 0; i < count; i++)
+        {
+            const auto& buffer = queue[i];
+            gather.emplace_back(buffer.read_ptr(), buffer.avail_read());
+            size += buffer.avail_read();
+        }
+
+        sending = true;
+
+        auto done = [self = shared_from_this(), count, size](error_code ec, std::size_t) {
+            self->sent(ec, count, size);
+        };
+
+        // the buffer sequence is copied by the operation
+        boost::asio::async_write(sock.boost_socket(), gather, std::move(done));
+    }
+
+    void sent(const error_code& ec, std::size_t count, std::size_t size)
+    {
+        for (std::size_t i = 0; i < count; i++)
+        {
+            queue.pop_front();
+        }
+
+        queued -= size;
+        sending = false;
+
+        if (ec)
+        {
+            error = ec;
+            queue.clear();
+            queued = 0;
+        }
+        else if (!queue.empty())
+        {
+            send();
+        }
+
+        if (queued <= limit)
+        {
+            space.wake();
+        }
+
+        if (!sending)
+        {
+            drained.wake();
+        }
+    }
+
+    socket& sock;
+    std::size_t limit;
+    std::size_t queued = 0;
+    std::deque<shared_buffer> queue;
+    std::vector<socket::const_buffer> gather;
+    bool sending = false;
+    error_code error;
+    // producers waiting for the queue to go below the limit
+    impl::wait_queue::head space;
+    // coroutines waiting for the queue to drain
+    impl::wait_queue::head drained;
+};
+
+write_queue::write_queue(socket& s, std::size_t limit) :
+    _state(std::make_shared<state>(s, limit))
+{}
+
+error_code write_queue::push(shared_buffer&& buffer)
+{
+    auto& s = *_state;
+
+    if (s.error)
+    {
+        return s.error;
+    }
+
+    s.queued += buffer.avail_read();
+    s.queue.push_back(std::move(buffer));
+
+    if (!s.sending)
+    {
+        s.send();
+    }
+
+    while (s.queued > s.limit && !s.error)
+    {
+        // cancellation of the producer is not an error of the queue
+        if (!s.space.wait())
+        {
+            return boost::asio::error::operation_aborted;
+        }
+    }
+
+    return s.error;
+}
+
+error_code write_queue::flush()
+{
+    auto& s = *_state;
+
+    while (s.sending)
+    {
+        if (!s.drained.wait())
+        {
+            return boost::asio::error::operation_aborted;
+        }
+    }
+
+    return s.error;
+}
+
+std::size_t write_queue::queued() const
+{
+    return _state->queued;
+}
+
+} // namespace async::tcp